@@ -108,7 +108,25 @@ if(UNIX)
 	check_symbol_exists("strerrorname_np" "string.h" HAVE_STRERRORNAME_NP)
 	check_symbol_exists("strptime"      "time.h"     HAVE_STRPTIME)
 	check_symbol_exists("vasprintf"     "stdio.h"    HAVE_VASPRINTF)
+	check_symbol_exists("fopencookie"   "stdio.h"    HAVE_FOPENCOOKIE)
+	check_symbol_exists("funopen"       "stdio.h"    HAVE_FUNOPEN)
 	cmake_pop_check_state()
+
+	#
+	# POSIX shared memory, for handing packets from dumpcap to TShark.
+	# Older versions of glibc have shm_open() in librt.
+	#
+	check_symbol_exists("shm_open"      "sys/mman.h" HAVE_SHM_OPEN)
+	if(NOT HAVE_SHM_OPEN)
+		cmake_push_check_state()
+		set(CMAKE_REQUIRED_LIBRARIES rt)
+		check_symbol_exists("shm_open"  "sys/mman.h" HAVE_SHM_OPEN_IN_LIBRT)
+		cmake_pop_check_state()
+		if(HAVE_SHM_OPEN_IN_LIBRT)
+			set(HAVE_SHM_OPEN 1)
+			set(SHM_LIBRARIES rt)
+		endif()
+	endif()
 endif()
 
 #Struct members
@@ -941,6 +941,8 @@ sync_pipe_start(capture_options *capture_opts, GPtrArray *capture_comments,
     if (capture_opts->save_file) {
         argv = sync_pipe_add_arg(argv, &argc, "-w");
         argv = sync_pipe_add_arg(argv, &argc, capture_opts->save_file);
+    } else if (capture_opts->use_shm_ring) {
+        argv = sync_pipe_add_arg(argv, &argc, "--shm-ring");
     }
     for (i = 0; i < argc; i++) {
         ws_debug("argv[%d]: %s", i, argv[i]);
@@ -2022,6 +2024,26 @@ sync_pipe_input_cb(GIOChannel *pipe_io, capture_session *cap_session)
         cap_session->drops(cap_session, num, name);
         break;
         }
+    case SP_WRITER_STATS: {
+        uint64_t bytes_in = 0, bytes_out = 0, reads = 0, backlogged = 0;
+        const char* end;
+
+        if (ws_strtou64(buffer, &end, &bytes_in) && end[0] == ':' &&
+            ws_strtou64(end + 1, &end, &bytes_out) && end[0] == ':' &&
+            ws_strtou64(end + 1, &end, &reads) && end[0] == ':' &&
+            ws_strtou64(end + 1, NULL, &backlogged)) {
+            ws_debug("ring buffer writer: %" PRIu64 " bytes in, %" PRIu64 " bytes out, %" PRIu64 "/%" PRIu64 " backlogged reads",
+                     bytes_in, bytes_out, backlogged, reads);
+            /* The compressor is behind for most of the chunks it takes */
+            if (reads > 0 && backlogged > reads / 2) {
+                ws_info("Ring buffer compression is falling behind the capture (%" PRIu64 "/%" PRIu64 " backlogged reads)",
+                        backlogged, reads);
+            }
+        } else {
+            ws_warning("Invalid writer statistics: %s", buffer);
+        }
+        break;
+        }
     default:
         if (g_ascii_isprint(indicator))
             ws_warning("Unknown indicator '%c'", indicator);
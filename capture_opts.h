@@ -326,6 +326,9 @@ typedef struct capture_options_tag {
                                                    files as we close them */
     char              *print_name_to;         /**< output file name */
     char              *temp_dir;              /**< temporary directory path */
+    bool               use_shm_ring;          /**< hand packets to the parent through
+                                                   shared memory instead of a temporary
+                                                   file, if there's no save_file */
 
     /* internally used (don't touch from outside) */
     bool               output_to_pipe;        /**< save_file is a pipe (named or stdout) */
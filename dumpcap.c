@@ -65,6 +65,7 @@
 
 #include <wsutil/clopts_common.h>
 #include <wsutil/privileges.h>
+#include <wsutil/shm_ring.h>
 
 #include "sync_pipe.h"
 
@@ -121,9 +122,6 @@ FILE *debug_log;   /* for logging debug messages to  */
 #include <stdarg.h> /* va_copy */
 #endif
 
-static GAsyncQueue *pcap_queue;
-static int64_t pcap_queue_bytes;
-static int64_t pcap_queue_packets;
 static int64_t pcap_queue_byte_limit;
 static int64_t pcap_queue_packet_limit;
 
@@ -268,6 +266,39 @@ typedef struct _pcapng_pipe_info {
 
 struct _loop_data; /* forward declaration so we can use it in the cap_pipe_dispatch function pointer */
 
+/*
+ * A slot in a capture ring. The packet data buffer is kept when the slot
+ * is reused, and only grown when a larger packet arrives, so that once
+ * the capture has warmed up no memory is allocated per packet.
+ */
+typedef struct _capture_ring_slot {
+    union {
+        struct pcap_pkthdr  phdr;
+        pcapng_block_header_t  bh;
+    } u;
+    uint64_t             ts;        /**< Timestamp in nanoseconds used to order the output; 0 for pcapng blocks */
+    uint8_t             *pd;
+    size_t               pd_size;   /**< Allocated size of pd */
+} capture_ring_slot;
+
+/*
+ * Single-producer, single-consumer ring of packets from one source to the
+ * writer. The reader thread of the source is the only one advancing head,
+ * and the main (writer) thread the only one advancing tail, so no lock is
+ * needed. One slot is always left empty to tell a full ring from an empty one.
+ *
+ * The slots are allocated in chunks by the producer the first time the
+ * ring reaches them, so a large packet limit (-N) costs nothing until
+ * that many packets are actually queued.
+ */
+typedef struct _capture_ring {
+    capture_ring_slot  **chunks;    /**< CAPTURE_RING_CHUNK_SLOTS slots each, or NULL if not used yet */
+    int                  num_chunks;
+    int                  num_slots;
+    int                  head;      /**< Next slot to fill; written by the producer only */
+    int                  tail;      /**< Next slot to write out; written by the consumer only */
+} capture_ring;
+
 /*
  * A source of packets from which we're capturing.
  */
@@ -318,6 +349,7 @@ typedef struct _capture_src {
     GMutex                      *cap_pipe_read_mtx;
     GAsyncQueue                 *cap_pipe_pending_q, *cap_pipe_done_q;
 #endif
+    capture_ring                 ring;                   /**< Packets queued for the writer, if use_threads */
 } capture_src;
 
 typedef struct _saved_idb {
@@ -348,6 +380,11 @@ typedef struct _loop_data {
     FILE     *pdh;
     int       save_file_fd;
     char     *io_buffer;           /**< Our IO buffer if we increase the size from the standard size */
+    shm_ring_t *shm_ring;          /**< Shared memory ring we write to instead of a file, if any */
+#ifndef _WIN32
+    pid_t     shm_ring_parent;     /**< Our parent, which reads from the ring */
+#endif
+    bool      shm_ring_reader_gone; /**< We gave up waiting for the ring's reader */
     uint64_t  bytes_written;       /**< Bytes written for the current file. */
     /* autostop conditions */
     int       packets_written;     /**< Packets written for the current file. */
@@ -358,14 +395,22 @@ typedef struct _loop_data {
     int      interval_s;
 } loop_data;
 
-typedef struct _pcap_queue_element {
-    capture_src        *pcap_src;
-    union {
-        struct pcap_pkthdr  phdr;
-        pcapng_block_header_t  bh;
-    } u;
-    uint8_t             *pd;
-} pcap_queue_element;
+/*
+ * The writer sleeps on this when all capture rings are empty; producers
+ * only take the mutex to wake it up if ring_writer_waiting is set.
+ */
+static GMutex ring_wakeup_mutex;
+static GCond ring_wakeup_cond;
+static int ring_writer_waiting;
+
+/*
+ * Bytes and packets queued in all the capture rings together, which is
+ * what -C and -N limit. Updated atomically by the reader threads and the
+ * writer. Reader threads check the limits independently, so with several
+ * interfaces the limits may be exceeded by a packet per interface.
+ */
+static size_t pcap_queue_bytes;
+static int pcap_queue_packets;
 
 /*
  * This needs to be static, so that the SIGINT handler can clear the "go"
@@ -408,6 +453,9 @@ static bool need_timeout_workaround;
 
 #define WRITER_THREAD_TIMEOUT 100000 /* usecs */
 
+/* Slots allocated at a time as a capture ring fills up */
+#define CAPTURE_RING_CHUNK_SLOTS 4096
+
 static void
 dumpcap_log_writer(const char *domain, enum ws_log_level level,
                                    const char *file, long line, const char *func,
@@ -439,6 +487,7 @@ WS_NORETURN static void exit_main(int err);
 
 static void report_new_capture_file(const char *filename);
 static void report_packet_count(unsigned int packet_count);
+static void report_writer_stats(void);
 static void report_packet_drops(uint32_t received, uint32_t pcap_drops, uint32_t drops, uint32_t flushed, uint32_t ps_ifdrop, char *name);
 static void report_capture_error(const char *error_msg, const char *secondary_error_msg);
 static void report_cfilter_error(capture_options *capture_opts, unsigned i, const char *errmsg);
@@ -540,8 +589,9 @@ print_usage(FILE *output)
 
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -N <packet_limit>        maximum number of packets buffered within dumpcap\n");
+    fprintf(output, "                           (all interfaces together)\n");
     fprintf(output, "  -C <byte_limit>          maximum number of bytes used for buffering packets\n");
-    fprintf(output, "                           within dumpcap\n");
+    fprintf(output, "                           within dumpcap (all interfaces together)\n");
     fprintf(output, "  -t                       use a separate thread per interface\n");
     fprintf(output, "  -q                       don't report packet capture counts\n");
     fprintf(output, "  -v, --version            print version information and exit\n");
@@ -3517,6 +3567,12 @@ capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *err
     /* Set up to write to the capture file. */
     if (capture_opts->multi_files_on) {
         ld->pdh = ringbuf_init_libpcap_fdopen(&err);
+    } else if (ld->shm_ring != NULL) {
+        /* The ring does its own batching; our parent reads straight out of it. */
+        ld->pdh = shm_ring_fdopen(ld->shm_ring);
+        if (ld->pdh == NULL) {
+            err = errno;
+        }
     } else {
         ld->pdh = ws_fdopen(ld->save_file_fd, "wb");
         if (ld->pdh == NULL) {
@@ -4040,6 +4096,75 @@ capture_loop_open_output(capture_options *capture_opts, int *save_file_fd,
     return true;
 }
 
+/* How long to wait for our parent to make room in the shared memory ring */
+#define SHM_RING_WRITER_TIMEOUT_USEC    (60 * G_USEC_PER_SEC)
+
+/*
+ * Called while the shared memory ring is full. Our parent only reads
+ * packets it has been told about, so tell it about everything we've
+ * written so far or it will never make room. Give up if we've been
+ * asked to stop, or if our parent went away or stopped reading.
+ */
+static bool
+capture_loop_shm_ring_wait(void *user_data, uint64_t waited_usec)
+{
+    loop_data *ld = (loop_data *)user_data;
+
+    if (ld->inpkts_to_sync_pipe) {
+        /* Even if quiet; our parent depends on it. */
+        report_packet_count(ld->inpkts_to_sync_pipe);
+        ld->inpkts_to_sync_pipe = 0;
+    }
+    if (!ld->go) {
+        return false;
+    }
+#ifndef _WIN32
+    if (getppid() != ld->shm_ring_parent) {
+        ws_info("Parent process went away; not waiting for it to read the shared memory");
+        ld->shm_ring_reader_gone = true;
+        return false;
+    }
+#endif
+    if (waited_usec > SHM_RING_WRITER_TIMEOUT_USEC) {
+        ws_info("Parent process stopped reading the shared memory");
+        ld->shm_ring_reader_gone = true;
+        return false;
+    }
+    return true;
+}
+
+/* create the shared memory ring our parent reads packets from, in place
+   of a temporary file */
+/* Returns true if the ring was created successfully, false otherwise. */
+static bool
+capture_loop_open_shm_output(capture_options *capture_opts, loop_data *ld,
+                             char *errmsg, int errmsg_len)
+{
+    char *name;
+    int   err;
+
+    name = ws_strdup_printf("/wireshark_%u", (unsigned)getpid());
+    ld->shm_ring = shm_ring_create(name, SHM_RING_DEFAULT_SIZE, &err);
+    if (ld->shm_ring == NULL) {
+        snprintf(errmsg, errmsg_len,
+                   "The shared memory to which the capture would be saved "
+                   "could not be created: %s.", g_strerror(err));
+        g_free(name);
+        return false;
+    }
+#ifndef _WIN32
+    ld->shm_ring_parent = getppid();
+#endif
+    ld->shm_ring_reader_gone = false;
+    shm_ring_set_wait_cb(ld->shm_ring, capture_loop_shm_ring_wait, ld);
+
+    /* capture_opts_cleanup will g_free(capture_opts->save_file). */
+    g_free(capture_opts->save_file);
+    capture_opts->save_file = g_strconcat(SHM_RING_PATH_PREFIX, name, NULL);
+    g_free(name);
+    return true;
+}
+
 static time_t get_next_time_interval(int interval_s) {
     time_t next_time = time(NULL);
     next_time -= next_time % interval_s;
@@ -4047,6 +4172,27 @@ static time_t get_next_time_interval(int interval_s) {
     return next_time;
 }
 
+/*
+ * Write out everything written to the capture file so far, before
+ * telling our parent about it. When ringbuffer files are compressed as
+ * they are written, that means waiting for the compressor, or our parent
+ * would read a file that ends in the middle of what we said is there.
+ */
+static void
+capture_loop_sync_output(capture_options *capture_opts)
+{
+    int err;
+
+    if (!capture_child || !capture_opts->multi_files_on) {
+        fflush(global_ld.pdh);
+        return;
+    }
+    if (!ringbuf_sync(&err)) {
+        global_ld.err = err;
+        global_ld.go = false;
+    }
+}
+
 /* Do the work of handling either the file size or file duration capture
    conditions being reached, and switching files or stopping. */
 static bool
@@ -4092,7 +4238,7 @@ do_file_switch_or_stop(capture_options *capture_opts)
             if (global_ld.next_interval_time) {
                 global_ld.next_interval_time = get_next_time_interval(global_ld.interval_s);
             }
-            fflush(global_ld.pdh);
+            capture_loop_sync_output(capture_opts);
             if (global_ld.inpkts_to_sync_pipe) {
                 if (!quiet)
                     report_packet_count(global_ld.inpkts_to_sync_pipe);
@@ -4131,44 +4277,191 @@ pcap_read_handler(void* arg)
     return (NULL);
 }
 
-/* Try to pop an item off the packet queue and if it exists, write it */
-static bool
-capture_loop_dequeue_packet(void) {
-    pcap_queue_element *queue_element;
+static void
+capture_ring_init(capture_ring *ring, int max_packets)
+{
+    /* Leave room for the empty slot without overflowing. */
+    if (max_packets > INT_MAX - 1) {
+        max_packets = INT_MAX - 1;
+    }
+    ring->num_slots = max_packets + 1;
+    ring->num_chunks = (ring->num_slots - 1) / CAPTURE_RING_CHUNK_SLOTS + 1;
+    ring->chunks = g_new0(capture_ring_slot *, ring->num_chunks);
+    ring->head = 0;
+    ring->tail = 0;
+}
 
-    g_async_queue_lock(pcap_queue);
-    queue_element = (pcap_queue_element *)g_async_queue_timeout_pop_unlocked(pcap_queue, WRITER_THREAD_TIMEOUT);
-    if (queue_element) {
-        if (queue_element->pcap_src->from_pcapng) {
-            pcap_queue_bytes -= queue_element->u.bh.block_total_length;
-        } else {
-            pcap_queue_bytes -= queue_element->u.phdr.caplen;
+/* Number of slots in a chunk of the ring; the last one may be short */
+static int
+capture_ring_chunk_slots(const capture_ring *ring, int chunk)
+{
+    return MIN(CAPTURE_RING_CHUNK_SLOTS, ring->num_slots - chunk * CAPTURE_RING_CHUNK_SLOTS);
+}
+
+static inline capture_ring_slot *
+capture_ring_slot_at(const capture_ring *ring, int i)
+{
+    return &ring->chunks[i / CAPTURE_RING_CHUNK_SLOTS][i % CAPTURE_RING_CHUNK_SLOTS];
+}
+
+static void
+capture_ring_free(capture_ring *ring)
+{
+    int chunk, i;
+
+    if (ring->chunks == NULL) {
+        return;
+    }
+    for (chunk = 0; chunk < ring->num_chunks; chunk++) {
+        if (ring->chunks[chunk] == NULL) {
+            continue;
         }
-        pcap_queue_packets -= 1;
+        for (i = 0; i < capture_ring_chunk_slots(ring, chunk); i++) {
+            g_free(ring->chunks[chunk][i].pd);
+        }
+        g_free(ring->chunks[chunk]);
     }
-    g_async_queue_unlock(pcap_queue);
-    if (queue_element) {
-        if (queue_element->pcap_src->from_pcapng) {
-            ws_info("Dequeued a block of type 0x%08x of length %d captured on interface %d.",
-                  queue_element->u.bh.block_type, queue_element->u.bh.block_total_length,
-                  queue_element->pcap_src->interface_id);
+    g_free(ring->chunks);
+    ring->chunks = NULL;
+}
 
-            capture_loop_write_pcapng_cb(queue_element->pcap_src,
-                                        &queue_element->u.bh,
-                                        queue_element->pd);
-        } else {
-            ws_info("Dequeued a packet of length %d captured on interface %d.",
-                queue_element->u.phdr.caplen, queue_element->pcap_src->interface_id);
+/*
+ * Get a free slot in the ring of this source with room for len bytes,
+ * or NULL if the queue limits have been reached.
+ * Called from the reader thread of the source.
+ */
+static capture_ring_slot *
+capture_ring_reserve(capture_src *pcap_src, size_t len)
+{
+    capture_ring *ring = &pcap_src->ring;
+    capture_ring_slot *slot;
+    int next = (ring->head + 1) % ring->num_slots;
+    int chunk;
+
+    if (next == g_atomic_int_get(&ring->tail)) {
+        /* ring full */
+        return NULL;
+    }
+    if ((pcap_queue_packet_limit > 0) &&
+        (g_atomic_int_get(&pcap_queue_packets) >= pcap_queue_packet_limit)) {
+        return NULL;
+    }
+    if ((pcap_queue_byte_limit > 0) &&
+        ((int64_t)(size_t)g_atomic_pointer_get(&pcap_queue_bytes) >= pcap_queue_byte_limit)) {
+        return NULL;
+    }
+    chunk = ring->head / CAPTURE_RING_CHUNK_SLOTS;
+    if (ring->chunks[chunk] == NULL) {
+        /* First time the ring has got this far. The consumer only looks
+           at slots before head, so it can't see the chunk until the
+           slot is published. */
+        ring->chunks[chunk] = g_new0(capture_ring_slot, capture_ring_chunk_slots(ring, chunk));
+    }
+    slot = capture_ring_slot_at(ring, ring->head);
+    if (slot->pd_size < len) {
+        g_free(slot->pd);
+        slot->pd = (uint8_t *)g_malloc(len);
+        slot->pd_size = len;
+    }
+    return slot;
+}
+
+/*
+ * Hand the slot filled after capture_ring_reserve() to the writer.
+ */
+static void
+capture_ring_publish(capture_src *pcap_src, size_t len)
+{
+    capture_ring *ring = &pcap_src->ring;
+
+    g_atomic_pointer_add(&pcap_queue_bytes, (ssize_t)len);
+    g_atomic_int_inc(&pcap_queue_packets);
+    g_atomic_int_set(&ring->head, (ring->head + 1) % ring->num_slots);
 
-            capture_loop_write_packet_cb((uint8_t *) queue_element->pcap_src,
-                                        &queue_element->u.phdr,
-                                        queue_element->pd);
+    if (g_atomic_int_get(&ring_writer_waiting)) {
+        g_mutex_lock(&ring_wakeup_mutex);
+        g_cond_signal(&ring_wakeup_cond);
+        g_mutex_unlock(&ring_wakeup_mutex);
+    }
+}
+
+/*
+ * Find the source whose next queued packet is the oldest, so that
+ * packets from multiple interfaces are written in timestamp order as
+ * far as what has been captured so far allows.
+ */
+static capture_src *
+capture_ring_oldest_src(void)
+{
+    capture_src *oldest_src = NULL;
+    uint64_t oldest_ts = 0;
+    unsigned i;
+
+    for (i = 0; i < global_ld.pcaps->len; i++) {
+        capture_src *pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+        capture_ring *ring = &pcap_src->ring;
+        uint64_t ts;
+
+        if (ring->tail == g_atomic_int_get(&ring->head)) {
+            continue;
+        }
+        ts = capture_ring_slot_at(ring, ring->tail)->ts;
+        if (oldest_src == NULL || ts < oldest_ts) {
+            oldest_src = pcap_src;
+            oldest_ts = ts;
         }
-        g_free(queue_element->pd);
-        g_free(queue_element);
-        return true;
     }
-    return false;
+    return oldest_src;
+}
+
+/* Try to take the oldest packet off the capture rings and if it exists, write it */
+static bool
+capture_loop_dequeue_packet(void) {
+    capture_src *pcap_src;
+    capture_ring *ring;
+    capture_ring_slot *slot;
+    size_t len;
+
+    pcap_src = capture_ring_oldest_src();
+    if (pcap_src == NULL) {
+        /* Nothing queued; wait for a reader thread to queue something. */
+        g_mutex_lock(&ring_wakeup_mutex);
+        g_atomic_int_set(&ring_writer_waiting, 1);
+        pcap_src = capture_ring_oldest_src();
+        if (pcap_src == NULL) {
+            g_cond_wait_until(&ring_wakeup_cond, &ring_wakeup_mutex,
+                              g_get_monotonic_time() + WRITER_THREAD_TIMEOUT);
+        }
+        g_atomic_int_set(&ring_writer_waiting, 0);
+        g_mutex_unlock(&ring_wakeup_mutex);
+        if (pcap_src == NULL) {
+            pcap_src = capture_ring_oldest_src();
+            if (pcap_src == NULL) {
+                return false;
+            }
+        }
+    }
+
+    ring = &pcap_src->ring;
+    slot = capture_ring_slot_at(ring, ring->tail);
+    if (pcap_src->from_pcapng) {
+        ws_info("Dequeued a block of type 0x%08x of length %d captured on interface %d.",
+              slot->u.bh.block_type, slot->u.bh.block_total_length,
+              pcap_src->interface_id);
+
+        capture_loop_write_pcapng_cb(pcap_src, &slot->u.bh, slot->pd);
+        len = slot->u.bh.block_total_length;
+    } else {
+        ws_info("Dequeued a packet of length %d captured on interface %d.",
+            slot->u.phdr.caplen, pcap_src->interface_id);
+
+        capture_loop_write_packet_cb((uint8_t *) pcap_src, &slot->u.phdr, slot->pd);
+        len = slot->u.phdr.caplen;
+    }
+    g_atomic_int_set(&ring->tail, (ring->tail + 1) % ring->num_slots);
+    g_atomic_pointer_add(&pcap_queue_bytes, -(ssize_t)len);
+    g_atomic_int_add(&pcap_queue_packets, -1);
+    return true;
 }
 
 /*
@@ -4287,8 +4580,13 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
     /* If we're supposed to write to a capture file, open it for output
        (temporary/specified name/ringbuffer) */
     if (capture_opts->saving_to_file) {
-        if (!capture_loop_open_output(capture_opts, &global_ld.save_file_fd,
-                                      errmsg, sizeof(errmsg))) {
+        if (capture_opts->use_shm_ring && capture_opts->save_file == NULL) {
+            if (!capture_loop_open_shm_output(capture_opts, &global_ld,
+                                              errmsg, sizeof(errmsg))) {
+                goto error;
+            }
+        } else if (!capture_loop_open_output(capture_opts, &global_ld.save_file_fd,
+                                             errmsg, sizeof(errmsg))) {
             goto error;
         }
 
@@ -4311,7 +4609,7 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
            message to our parent so that they'll open the capture file and
            update its windows to indicate that we have a live capture in
            progress. */
-        fflush(global_ld.pdh);
+        capture_loop_sync_output(capture_opts);
         report_new_capture_file(capture_opts->save_file);
     }
 
@@ -4348,9 +4646,18 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
     /* WOW, everything is prepared! */
     /* please fasten your seat belts, we will enter now the actual capture loop */
     if (use_threads) {
-        pcap_queue = g_async_queue_new();
+        /* The queue limits apply to all the rings together, but any one
+           interface may fill the whole queue. Without a packet limit,
+           every packet takes at least a byte of the byte limit, so that
+           many slots are enough; slots are only allocated as they're
+           used. */
         pcap_queue_bytes = 0;
         pcap_queue_packets = 0;
+        for (i = 0; i < global_ld.pcaps->len; i++) {
+            pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+            capture_ring_init(&pcap_src->ring, (pcap_queue_packet_limit > 0) ?
+                              (int)pcap_queue_packet_limit : (int)pcap_queue_byte_limit);
+        }
         for (i = 0; i < global_ld.pcaps->len; i++) {
             pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
             /* XXX - Add an interface name here? */
@@ -4434,7 +4741,7 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
             /* Let the parent process know. */
             if (global_ld.inpkts_to_sync_pipe) {
                 /* do sync here */
-                fflush(global_ld.pdh);
+                capture_loop_sync_output(capture_opts);
 
                 /* Send our parent a message saying we've written out
                    "global_ld.inpkts_to_sync_pipe" packets to the capture file. */
@@ -4443,6 +4750,9 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
 
                 global_ld.inpkts_to_sync_pipe = 0;
             }
+            if (capture_child && capture_opts->multi_files_on) {
+                report_writer_stats();
+            }
 
             /* check capture duration condition */
             if (autostop_duration_timer != NULL && g_timer_elapsed(autostop_duration_timer, NULL) >= capture_opts->autostop_duration) {
@@ -4485,6 +4795,10 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
                 fflush(global_ld.pdh);
             }
         }
+        for (i = 0; i < global_ld.pcaps->len; i++) {
+            pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+            capture_ring_free(&pcap_src->ring);
+        }
     }
 
 
@@ -4625,6 +4939,13 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
     if (capture_opts->saving_to_file) {
         /* close the output file */
         close_ok = capture_loop_close_output(capture_opts, &global_ld, &err_close);
+        /* Our parent has the ring mapped and unlinks it once it has
+           opened it; if it went away, nobody else will remove it. */
+        if (global_ld.shm_ring_reader_gone)
+            shm_ring_discard(global_ld.shm_ring);
+        else
+            shm_ring_close(global_ld.shm_ring);
+        global_ld.shm_ring = NULL;
     } else
         close_ok = true;
 
@@ -4635,6 +4956,9 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
             report_packet_count(global_ld.inpkts_to_sync_pipe);
         global_ld.inpkts_to_sync_pipe = 0;
     }
+    if (capture_opts->saving_to_file && capture_opts->multi_files_on) {
+        report_writer_stats();
+    }
 
     /* If we've displayed a message about a write error, there's no point
        in displaying another message about an error on close. */
@@ -4702,7 +5026,10 @@ error:
 
         /* We couldn't even start the capture, so get rid of the capture
            file. */
-        if (capture_opts->save_file != NULL) {
+        if (global_ld.shm_ring != NULL) {
+            shm_ring_discard(global_ld.shm_ring);
+            global_ld.shm_ring = NULL;
+        } else if (capture_opts->save_file != NULL) {
             ws_unlink(capture_opts->save_file);
         }
     }
@@ -4952,8 +5279,7 @@ capture_loop_queue_packet_cb(uint8_t *pcap_src_p, const struct pcap_pkthdr *phdr
                              const uint8_t *pd)
 {
     capture_src        *pcap_src = (capture_src *) (void *) pcap_src_p;
-    pcap_queue_element *queue_element;
-    bool                limit_reached;
+    capture_ring_slot  *slot;
 
     /* We may be called multiple times from pcap_dispatch(); if we've set
        the "stop capturing" flag, ignore this packet, as we're not
@@ -4963,54 +5289,29 @@ capture_loop_queue_packet_cb(uint8_t *pcap_src_p, const struct pcap_pkthdr *phdr
         return;
     }
 
-    queue_element = g_new(pcap_queue_element, 1);
-    if (queue_element == NULL) {
-       pcap_src->dropped++;
-       return;
-    }
-    queue_element->pcap_src = pcap_src;
-    queue_element->u.phdr = *phdr;
-    queue_element->pd = (uint8_t *)g_malloc(phdr->caplen);
-    if (queue_element->pd == NULL) {
+    slot = capture_ring_reserve(pcap_src, phdr->caplen);
+    if (slot == NULL) {
         pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
-    memcpy(queue_element->pd, pd, phdr->caplen);
-    g_async_queue_lock(pcap_queue);
-    if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
-        ((pcap_queue_packet_limit == 0) || (pcap_queue_packets < pcap_queue_packet_limit))) {
-        limit_reached = false;
-        g_async_queue_push_unlocked(pcap_queue, queue_element);
-        pcap_queue_bytes += phdr->caplen;
-        pcap_queue_packets += 1;
-    } else {
-        limit_reached = true;
-    }
-    g_async_queue_unlock(pcap_queue);
-    if (limit_reached) {
-        pcap_src->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
         ws_info("Dropped a packet of length %d captured on interface %u.",
               phdr->caplen, pcap_src->interface_id);
-    } else {
-        pcap_src->received++;
-        ws_info("Queued a packet of length %d captured on interface %u.",
-              phdr->caplen, pcap_src->interface_id);
+        return;
     }
-    /* I don't want to hold the mutex over the debug output. So the
-       output may be wrong */
-    ws_info("Queue size is now %" PRId64 " bytes (%" PRId64 " packets)",
-          pcap_queue_bytes, pcap_queue_packets);
+    slot->u.phdr = *phdr;
+    slot->ts = (uint64_t)phdr->ts.tv_sec * 1000000000 +
+               (uint64_t)phdr->ts.tv_usec * (pcap_src->ts_nsec ? 1 : 1000);
+    memcpy(slot->pd, pd, phdr->caplen);
+    capture_ring_publish(pcap_src, phdr->caplen);
+
+    pcap_src->received++;
+    ws_info("Queued a packet of length %d captured on interface %u.",
+          phdr->caplen, pcap_src->interface_id);
 }
 
 /* one pcapng block was captured, queue it */
 static void
 capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t *bh, uint8_t *pd)
 {
-    pcap_queue_element *queue_element;
-    bool                limit_reached;
+    capture_ring_slot  *slot;
 
     /* We may be called multiple times from pcap_dispatch(); if we've set
        the "stop capturing" flag, ignore this packet, as we're not
@@ -5020,46 +5321,23 @@ capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
         return;
     }
 
-    queue_element = g_new(pcap_queue_element, 1);
-    if (queue_element == NULL) {
-       pcap_src->dropped++;
-       return;
-    }
-    queue_element->pcap_src = pcap_src;
-    queue_element->u.bh = *bh;
-    queue_element->pd = (uint8_t *)g_malloc(bh->block_total_length);
-    if (queue_element->pd == NULL) {
-        pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
-    memcpy(queue_element->pd, pd, bh->block_total_length);
-    g_async_queue_lock(pcap_queue);
-    if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
-        ((pcap_queue_packet_limit == 0) || (pcap_queue_packets < pcap_queue_packet_limit))) {
-        limit_reached = false;
-        g_async_queue_push_unlocked(pcap_queue, queue_element);
-        pcap_queue_bytes += bh->block_total_length;
-        pcap_queue_packets += 1;
-    } else {
-        limit_reached = true;
-    }
-    g_async_queue_unlock(pcap_queue);
-    if (limit_reached) {
+    slot = capture_ring_reserve(pcap_src, bh->block_total_length);
+    if (slot == NULL) {
         pcap_src->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
         ws_info("Dropped a packet of length %d captured on interface %u.",
               bh->block_total_length, pcap_src->interface_id);
-    } else {
-        pcap_src->received++;
-        ws_info("Queued a block of type 0x%08x of length %d captured on interface %u.",
-              bh->block_type, bh->block_total_length, pcap_src->interface_id);
+        return;
     }
-    /* I don't want to hold the mutex over the debug output. So the
-       output may be wrong */
-    ws_info("Queue size is now %" PRId64 " bytes (%" PRId64 " packets)",
-          pcap_queue_bytes, pcap_queue_packets);
+    slot->u.bh = *bh;
+    /* Blocks from a pcapng pipe aren't all packets, and the timestamp
+       resolution depends on their IDB; just write them out as they come. */
+    slot->ts = 0;
+    memcpy(slot->pd, pd, bh->block_total_length);
+    capture_ring_publish(pcap_src, bh->block_total_length);
+
+    pcap_src->received++;
+    ws_info("Queued a block of type 0x%08x of length %d captured on interface %u.",
+          bh->block_type, bh->block_total_length, pcap_src->interface_id);
 }
 
 static int
@@ -5141,6 +5419,7 @@ gather_dumpcap_runtime_info(feature_list l)
 #ifdef _WIN32
 #define LONGOPT_SIGNAL_PIPE        LONGOPT_BASE_APPLICATION+4
 #endif
+#define LONGOPT_SHM_RING           LONGOPT_BASE_APPLICATION+5
 
 /* And now our feature presentation... [ fade to music ] */
 int
@@ -5158,6 +5437,7 @@ main(int argc, char *argv[])
 #ifdef _WIN32
         {"signal-pipe", ws_required_argument, NULL, LONGOPT_SIGNAL_PIPE},
 #endif
+        {"shm-ring", ws_no_argument, NULL, LONGOPT_SHM_RING},
         {0, 0, 0, 0 }
     };
 
@@ -5581,6 +5861,17 @@ main(int argc, char *argv[])
             }
             break;
 #endif
+        case LONGOPT_SHM_RING:
+            if (!capture_child) {
+                cmdarg_err("--shm-ring may only be specified with -Z");
+                exit_main(1);
+            }
+            if (!shm_ring_is_supported()) {
+                cmdarg_err("Shared memory capture handoff isn't supported on this platform");
+                exit_main(1);
+            }
+            global_capture_opts.use_shm_ring = true;
+            break;
         case 'q':        /* Quiet */
             quiet = true;
             break;
@@ -6126,6 +6417,39 @@ report_packet_count(unsigned int packet_count)
     }
 }
 
+/*
+ * Report how the thread compressing ring buffer files is keeping up, if
+ * files are compressed as they are written. A large share of backlogged
+ * reads means the compressor, not the capture, is the bottleneck.
+ */
+static void
+report_writer_stats(void)
+{
+    ringbuf_writer_stats stats;
+
+    if (!ringbuf_get_writer_stats(&stats)) {
+        return;
+    }
+
+    if (capture_child) {
+        char *tmp = ws_strdup_printf("%" PRIu64 ":%" PRIu64 ":%" PRIu64 ":%" PRIu64,
+                                     stats.bytes_in, stats.bytes_out,
+                                     stats.reads, stats.backlogged_reads);
+
+        ws_debug("Writer: %s", tmp);
+        sync_pipe_write_string_msg(sync_pipe_fd, SP_WRITER_STATS, tmp);
+        g_free(tmp);
+    } else {
+        if (!really_quiet) {
+            fprintf(stderr,
+                "Compressed %" PRIu64 " bytes to %" PRIu64 " (%" PRIu64 "/%" PRIu64 " backlogged reads)\n",
+                stats.bytes_in, stats.bytes_out, stats.backlogged_reads, stats.reads);
+            /* stderr could be line buffered */
+            fflush(stderr);
+        }
+    }
+}
+
 static void
 report_new_capture_file(const char *filename)
 {
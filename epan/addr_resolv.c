@@ -107,31 +107,32 @@
 #define ENAME_VLANS     "vlans"
 #define ENAME_SS7PCS    "ss7pcs"
 #define ENAME_ENTERPRISES "enterprises"
+#define ENAME_DNS_CACHE "dns_cache"
 
 #define HASHETHSIZE      2048
-#define HASHHOSTSIZE     2048
 #define HASHIPXNETSIZE    256
-#define SUBNETLENGTHSIZE   32  /*1-32 inc.*/
 
-/* hash table used for IPv4 lookup */
 
-#define HASH_IPV4_ADDRESS(addr) (g_htonl(addr) & (HASHHOSTSIZE - 1))
+/*
+ * Subnets are kept in a multibit trie per address family, each level of
+ * which consumes SUBNET_TRIE_STRIDE bits of the address. A subnet whose
+ * mask length isn't a multiple of the stride fills all the slots of its
+ * last level that it covers (unless they hold a longer subnet), so the
+ * longest matching subnet is found with one array index per level.
+ */
+#define SUBNET_TRIE_STRIDE  4   /* must divide 8 */
+#define SUBNET_TRIE_SLOTS   (1 << SUBNET_TRIE_STRIDE)
 
+typedef struct subnet_name {
+    unsigned            mask_length;
+    struct subnet_name *next;           /* list of all subnets, for freeing */
+    char                name[MAXNAMELEN];
+} subnet_name_t;
 
-typedef struct sub_net_hashipv4 {
-    unsigned          addr;
-    /* XXX: No longer needed?*/
-    uint8_t           flags;          /* B0 dummy_entry, B1 resolve, B2 If the address is used in the trace */
-    struct sub_net_hashipv4   *next;
-    char              name[MAXNAMELEN];
-} sub_net_hashipv4_t;
-
-/* Array of entries of subnets of different lengths */
-typedef struct {
-    size_t       mask_length;      /*1-32*/
-    uint32_t     mask;             /* e.g. 255.255.255.*/
-    sub_net_hashipv4_t** subnet_addresses; /* Hash table of subnet addresses */
-} subnet_length_entry_t;
+typedef struct subnet_trie_node {
+    struct subnet_trie_node *children[SUBNET_TRIE_SLOTS];
+    subnet_name_t           *subnets[SUBNET_TRIE_SLOTS];
+} subnet_trie_node_t;
 
 
 /* hash table used for IPX network lookup */
@@ -244,8 +245,9 @@ static wmem_map_t *serv_port_custom_hashtable;
 // Maps enterprise-id -> enterprise-desc (only used for user additions)
 static GHashTable *enterprises_hashtable;
 
-static subnet_length_entry_t subnet_length_entries[SUBNETLENGTHSIZE]; /* Ordered array of entries */
-static bool have_subnet_entry;
+static subnet_trie_node_t *subnet_trie_ipv4;
+static subnet_trie_node_t *subnet_trie_ipv6;
+static subnet_name_t *subnet_names;
 
 static bool new_resolved_objects;
 
@@ -310,6 +312,25 @@ e_addr_resolve gbl_resolv_flags = {
 static unsigned name_resolve_concurrency = 500;
 static bool resolve_synchronously;
 
+/*
+ * Results of reverse DNS lookups, kept in a file in the personal
+ * configuration directory so that they can be reused by later runs.
+ * c-ares doesn't give us the TTL of the records, so entries expire
+ * after a fixed time, which is shorter for addresses that didn't
+ * resolve.
+ */
+static bool use_dns_cache;
+static unsigned dns_cache_lifetime = 24;            /* hours */
+static unsigned dns_cache_negative_lifetime = 60;   /* minutes */
+
+typedef struct {
+    time_t  expires;
+    char   *name;       /* NULL if the address has no name */
+} dns_cache_entry_t;
+
+static GHashTable *dns_cache;   /* address string -> dns_cache_entry_t */
+static bool dns_cache_changed;
+
 /*
  *  Global variables (can be changed in GUI sections)
  *  XXX - they could be changed in GUI code, but there's currently no
@@ -356,6 +377,9 @@ typedef struct _async_hostent {
 static void
 c_ares_ghba_cb(void *arg, int status, int timeouts _U_, struct hostent *he);
 
+static void
+dns_cache_add_ares_result(int family, const void *addrp, int status, const struct hostent *he);
+
 /*
  * Submitted synchronous queries trigger a callback (c_ares_ghba_sync_cb()).
  * The callback processes the response, sets completed to true if
@@ -455,6 +479,8 @@ c_ares_ghba_sync_cb(void *arg, int status, int timeouts _U_, struct hostent *he)
     sync_dns_data_t *sdd = (sync_dns_data_t *)arg;
     char **p;
 
+    dns_cache_add_ares_result(sdd->family, &sdd->addr, status, he);
+
     if (status == ARES_SUCCESS) {
         for (p = he->h_addr_list; *p != NULL; p++) {
             switch(sdd->family) {
@@ -764,12 +790,211 @@ fgetline(char *buf, int size, FILE *fp)
 
 } /* fgetline */
 
+static void
+dns_cache_entry_free(void *data)
+{
+    dns_cache_entry_t *entry = (dns_cache_entry_t *)data;
+
+    g_free(entry->name);
+    g_free(entry);
+}
+
+/* Read in the DNS cache file.
+ * <line> = <address> <whitespace> <expiry time> [<whitespace> <name>]
+ * <expiry time> is in seconds since the Epoch.
+ * Expired and malformed entries are ignored.
+ */
+static void
+dns_cache_read(void)
+{
+    char *path;
+    FILE *fp;
+    char line[MAX_LINELEN];
+    char *addr, *expires_str, *name;
+    int64_t expires;
+    time_t now = time(NULL);
+    dns_cache_entry_t *entry;
+
+    dns_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, dns_cache_entry_free);
+    dns_cache_changed = false;
+
+    path = get_persconffile_path(ENAME_DNS_CACHE, false);
+    if ((fp = ws_fopen(path, "r")) == NULL) {
+        if (errno != ENOENT)
+            report_open_failure(path, errno, false);
+        g_free(path);
+        return;
+    }
+    g_free(path);
+
+    while (fgetline(line, sizeof(line), fp) >= 0) {
+        if (line[0] == '#')
+            continue;
+
+        if ((addr = strtok(line, " \t")) == NULL ||
+            (expires_str = strtok(NULL, " \t")) == NULL)
+            continue;
+
+        if (!ws_strtoi64(expires_str, NULL, &expires) || expires <= now)
+            continue;
+
+        name = strtok(NULL, " \t");
+
+        entry = g_new(dns_cache_entry_t, 1);
+        entry->expires = (time_t)expires;
+        entry->name = g_strdup(name);
+        g_hash_table_replace(dns_cache, g_strdup(addr), entry);
+    }
+
+    fclose(fp);
+}
+
+/* Write out the DNS cache file, if it has changed, and free the cache. */
+static void
+dns_cache_write(void)
+{
+    char *pf_dir_path;
+    char *path, *path_new;
+    FILE *fp;
+    GHashTableIter iter;
+    void *key, *value;
+    time_t now = time(NULL);
+
+    if (dns_cache == NULL)
+        return;
+
+    if (!dns_cache_changed)
+        goto done;
+
+    if (create_persconffile_dir(&pf_dir_path) == -1) {
+        report_failure("Can't create directory\n\"%s\"\nfor the DNS cache file: %s.",
+                       pf_dir_path, g_strerror(errno));
+        g_free(pf_dir_path);
+        goto done;
+    }
+
+    path = get_persconffile_path(ENAME_DNS_CACHE, false);
+    path_new = ws_strdup_printf("%s.new", path);
+    if ((fp = ws_fopen(path_new, "w")) == NULL) {
+        report_open_failure(path_new, errno, true);
+        g_free(path_new);
+        g_free(path);
+        goto done;
+    }
+
+    fputs("# Reverse DNS cache, written by Wireshark and TShark.\n"
+          "# <address> <expiry time in seconds since the Epoch> [<name>]\n", fp);
+    g_hash_table_iter_init(&iter, dns_cache);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        dns_cache_entry_t *entry = (dns_cache_entry_t *)value;
+
+        if (entry->expires <= now)
+            continue;
+        if (entry->name != NULL)
+            fprintf(fp, "%s %" PRId64 " %s\n", (const char *)key, (int64_t)entry->expires, entry->name);
+        else
+            fprintf(fp, "%s %" PRId64 "\n", (const char *)key, (int64_t)entry->expires);
+    }
+
+    if (fclose(fp) == EOF) {
+        report_write_failure(path_new, errno);
+        ws_unlink(path_new);
+    } else if (ws_rename(path_new, path) < 0) {
+        report_failure("Can't rename \"%s\" to \"%s\": %s.",
+                       path_new, path, g_strerror(errno));
+        ws_unlink(path_new);
+    }
+    g_free(path_new);
+    g_free(path);
+
+done:
+    g_hash_table_destroy(dns_cache);
+    dns_cache = NULL;
+}
+
+/* Get the unexpired cache entry for an address, if any. */
+static const dns_cache_entry_t *
+dns_cache_lookup(const char *addr)
+{
+    dns_cache_entry_t *entry;
+
+    if (!use_dns_cache)
+        return NULL;
+
+    if (dns_cache == NULL)
+        dns_cache_read();
+
+    entry = (dns_cache_entry_t *)g_hash_table_lookup(dns_cache, addr);
+    if (entry == NULL || entry->expires <= time(NULL))
+        return NULL;
+
+    return entry;
+}
+
+/* Remember the result of a reverse lookup. name is NULL if the address
+ * has no name. */
+static void
+dns_cache_add(int family, const void *addrp, const char *name)
+{
+    char addr[WS_INET6_ADDRSTRLEN];
+    dns_cache_entry_t *entry;
+
+    if (!use_dns_cache)
+        return;
+
+    if (dns_cache == NULL)
+        dns_cache_read();
+
+    switch (family) {
+        case AF_INET:
+            ip_addr_to_str_buf((const ws_in4_addr *)addrp, addr, sizeof(addr));
+            break;
+        case AF_INET6:
+            ip6_to_str_buf((const ws_in6_addr *)addrp, addr, sizeof(addr));
+            break;
+        default:
+            return;
+    }
+
+    if (name != NULL && name[0] == '\0')
+        name = NULL;
+
+    entry = g_new(dns_cache_entry_t, 1);
+    if (name != NULL)
+        entry->expires = time(NULL) + (time_t)dns_cache_lifetime * 60 * 60;
+    else
+        entry->expires = time(NULL) + (time_t)dns_cache_negative_lifetime * 60;
+    entry->name = g_strdup(name);
+    g_hash_table_replace(dns_cache, g_strdup(addr), entry);
+    dns_cache_changed = true;
+}
+
+/* Remember the result of a reverse lookup done with c-ares, unless it
+ * failed for a reason that might not apply next time (a timeout, a
+ * server failure, the lookup being cancelled, ...). */
+static void
+dns_cache_add_ares_result(int family, const void *addrp, int status, const struct hostent *he)
+{
+    switch (status) {
+        case ARES_SUCCESS:
+            dns_cache_add(family, addrp, he->h_name);
+            break;
+        case ARES_ENOTFOUND:
+        case ARES_ENODATA:
+            dns_cache_add(family, addrp, NULL);
+            break;
+        default:
+            break;
+    }
+}
+
 
 /*
  *  Local function definitions
  */
 static subnet_entry_t subnet_lookup(const uint32_t addr);
-static void subnet_entry_set(uint32_t subnet_addr, const uint8_t mask_length, const char* name);
+static const subnet_name_t *subnet_trie_lookup(const subnet_trie_node_t *node, const uint8_t *addr, unsigned addr_bits);
+static void subnet_trie_insert(subnet_trie_node_t **root, const uint8_t *addr, unsigned mask_length, const char* name);
 
 static unsigned serv_port_custom_hash(const void *k)
 {
@@ -1267,8 +1492,38 @@ fill_dummy_ip4(const unsigned addr, hashipv4_t* volatile tp)
 static void
 fill_dummy_ip6(hashipv6_t* volatile tp)
 {
+    const subnet_name_t *subnet;
+
     /* Overwrite if we get async DNS reply */
-    (void) g_strlcpy(tp->name, tp->ip6, MAXNAMELEN);
+
+    /* Do we have a subnet for this address? */
+    subnet = subnet_trie_lookup(subnet_trie_ipv6, tp->addr, 128);
+    if (subnet != NULL) {
+        /* Print name, then ':' then the address with the subnet prefix
+         * cleared, e.g. "name::1" for 2001:db8::1 in 2001:db8::/32, or
+         * "name:0:db8::1" in 2001::/20. The address string already
+         * starts with the separator if its first groups are zero. */
+        ws_in6_addr host_addr;
+        char buffer[WS_INET6_ADDRSTRLEN];
+        unsigned i;
+
+        if (subnet->mask_length == 128) {
+            (void) g_strlcpy(tp->name, subnet->name, MAXNAMELEN);
+            return;
+        }
+
+        memcpy(host_addr.bytes, tp->addr, sizeof host_addr.bytes);
+        for (i = 0; i < subnet->mask_length / 8; i++)
+            host_addr.bytes[i] = 0;
+        if (subnet->mask_length % 8)
+            host_addr.bytes[i] &= 0xff >> (subnet->mask_length % 8);
+        ip6_to_str_buf(&host_addr, buffer, sizeof buffer);
+
+        snprintf(tp->name, MAXNAMELEN, "%s%s%s", subnet->name,
+                 buffer[0] == ':' ? "" : ":", buffer);
+    } else {
+        (void) g_strlcpy(tp->name, tp->ip6, MAXNAMELEN);
+    }
 }
 
 static void
@@ -1280,6 +1535,8 @@ c_ares_ghba_cb(void *arg, int status, int timeouts _U_, struct hostent *he) {
     /* XXX, what to do if async_dns_in_flight == 0? */
     async_dns_in_flight--;
 
+    dns_cache_add_ares_result(caqm->family, &caqm->addr, status, he);
+
     if (status == ARES_SUCCESS) {
         for (p = he->h_addr_list; *p != NULL; p++) {
             switch(caqm->family) {
@@ -1337,8 +1594,19 @@ host_lookup(const unsigned addr)
         return tp;
 
     if (gbl_resolv_flags.use_external_net_name_resolver) {
+        const dns_cache_entry_t *cached;
+
         tp->flags |= TRIED_RESOLVE_ADDRESS;
 
+        /* Did an earlier run look it up? */
+        if ((cached = dns_cache_lookup(tp->ip)) != NULL) {
+            if (cached->name != NULL) {
+                (void) g_strlcpy(tp->name, cached->name, MAXNAMELEN);
+                tp->flags |= NAME_RESOLVED;
+            }
+            return tp;
+        }
+
         if (async_dns_initialized) {
             /* c-ares is initialized, so we can use it */
             if (resolve_synchronously || name_resolve_concurrency == 0) {
@@ -1412,8 +1680,19 @@ host_lookup6(const ws_in6_addr *addr)
         return tp;
 
     if (gbl_resolv_flags.use_external_net_name_resolver) {
+        const dns_cache_entry_t *cached;
+
         tp->flags |= TRIED_RESOLVE_ADDRESS;
 
+        /* Did an earlier run look it up? */
+        if ((cached = dns_cache_lookup(tp->ip6)) != NULL) {
+            if (cached->name != NULL) {
+                (void) g_strlcpy(tp->name, cached->name, MAXNAMELEN);
+                tp->flags |= NAME_RESOLVED;
+            }
+            return tp;
+        }
+
         if (async_dns_initialized) {
             /* c-ares is initialized, so we can use it */
             if (resolve_synchronously || name_resolve_concurrency == 0) {
@@ -2852,15 +3131,13 @@ get_addrinfo_list(void)
  * <line> = <comment> | <entry> | <whitespace>
  * <comment> = <whitespace>#<any>
  * <entry> = <subnet_definition> <whitespace> <subnet_name> [<comment>|<whitespace><any>]
- * <subnet_definition> = <ipv4_address> / <subnet_mask_length>
- * <ipv4_address> is a full address; it will be masked to get the subnet-ID.
- * <subnet_mask_length> is a decimal 1-31
+ * <subnet_definition> = <ip_address> / <subnet_mask_length>
+ * <ip_address> is a full IPv4 or IPv6 address; it will be masked to get the subnet-ID.
+ * <subnet_mask_length> is a decimal 1-32 (IPv4) or 1-128 (IPv6)
  * <subnet_name> is a string containing no whitespace.
  * <whitespace> = (space | tab)+
  * Any malformed entries are ignored.
  * Any trailing data after the subnet_name is ignored.
- *
- * XXX Support IPv6
  */
 static bool
 read_subnets_file (const char *subnetspath)
@@ -2868,8 +3145,11 @@ read_subnets_file (const char *subnetspath)
     FILE *hf;
     char line[MAX_LINELEN];
     char *cp, *cp2;
-    uint32_t host_addr; /* IPv4 ONLY */
-    uint8_t mask_length;
+    uint32_t host_addr;
+    ws_in6_addr host_addr6;
+    subnet_trie_node_t **trie;
+    const uint8_t *addr_bytes;
+    uint8_t mask_length, max_mask_length;
 
     if ((hf = ws_fopen(subnetspath, "r")) == NULL)
         return false;
@@ -2891,64 +3171,71 @@ read_subnets_file (const char *subnetspath)
         *cp2 = '\0'; /* Cut token */
         ++cp2    ;
 
-        /* Check if this is a valid IPv4 address */
-        if (!str_to_ip(cp, &host_addr)) {
+        /* Check if this is a valid IPv4 or IPv6 address */
+        if (str_to_ip(cp, &host_addr)) {
+            trie = &subnet_trie_ipv4;
+            addr_bytes = (const uint8_t *)&host_addr;
+            max_mask_length = 32;
+        } else if (str_to_ip6(cp, &host_addr6)) {
+            trie = &subnet_trie_ipv6;
+            addr_bytes = host_addr6.bytes;
+            max_mask_length = 128;
+        } else {
             continue; /* no */
         }
 
-        if (!ws_strtou8(cp2, NULL, &mask_length) || mask_length == 0 || mask_length > 32) {
+        if (!ws_strtou8(cp2, NULL, &mask_length) || mask_length == 0 || mask_length > max_mask_length) {
             continue; /* invalid mask length */
         }
 
         if ((cp = strtok(NULL, " \t")) == NULL)
             continue; /* no subnet name */
 
-        subnet_entry_set(host_addr, mask_length, cp);
+        subnet_trie_insert(trie, addr_bytes, mask_length, cp);
     }
 
     fclose(hf);
     return true;
 } /* read_subnets_file */
 
-static subnet_entry_t
-subnet_lookup(const uint32_t addr)
+/* Get the slot for an address in a given level of a subnet trie. */
+static inline unsigned
+subnet_trie_slot(const uint8_t *addr, unsigned level)
 {
-    subnet_entry_t subnet_entry;
-    uint32_t i;
-
-    /* Search mask lengths linearly, longest first */
-
-    i = SUBNETLENGTHSIZE;
-    while(have_subnet_entry && i > 0) {
-        uint32_t masked_addr;
-        subnet_length_entry_t* length_entry;
-
-        /* Note that we run from 31 (length 32)  to 0 (length 1)  */
-        --i;
-        ws_assert(i < SUBNETLENGTHSIZE);
+    unsigned bit = level * SUBNET_TRIE_STRIDE;
 
+    return (addr[bit / 8] >> (8 - SUBNET_TRIE_STRIDE - bit % 8)) & (SUBNET_TRIE_SLOTS - 1);
+}
 
-        length_entry = &subnet_length_entries[i];
+static const subnet_name_t *
+subnet_trie_lookup(const subnet_trie_node_t *node, const uint8_t *addr, unsigned addr_bits)
+{
+    const subnet_name_t *subnet = NULL;
+    unsigned level, slot;
 
-        if (NULL != length_entry->subnet_addresses) {
-            sub_net_hashipv4_t * tp;
-            uint32_t hash_idx;
+    /* The subnets found further down are longer */
+    for (level = 0; node != NULL && level * SUBNET_TRIE_STRIDE < addr_bits; level++) {
+        slot = subnet_trie_slot(addr, level);
+        if (node->subnets[slot] != NULL)
+            subnet = node->subnets[slot];
+        node = node->children[slot];
+    }
 
-            masked_addr = addr & length_entry->mask;
-            hash_idx = HASH_IPV4_ADDRESS(masked_addr);
+    return subnet;
+}
 
-            tp = length_entry->subnet_addresses[hash_idx];
-            while(tp != NULL && tp->addr != masked_addr) {
-                tp = tp->next;
-            }
+static subnet_entry_t
+subnet_lookup(const uint32_t addr)
+{
+    subnet_entry_t subnet_entry;
+    const subnet_name_t *subnet;
 
-            if (NULL != tp) {
-                subnet_entry.mask = length_entry->mask;
-                subnet_entry.mask_length = i + 1; /* Length is offset + 1 */
-                subnet_entry.name = tp->name;
-                return subnet_entry;
-            }
-        }
+    subnet = subnet_trie_lookup(subnet_trie_ipv4, (const uint8_t *)&addr, 32);
+    if (subnet != NULL) {
+        subnet_entry.mask = g_htonl(ws_ipv4_get_subnet_mask(subnet->mask_length));
+        subnet_entry.mask_length = subnet->mask_length;
+        subnet_entry.name = subnet->name;
+        return subnet_entry;
     }
 
     subnet_entry.mask = 0;
@@ -2958,66 +3245,67 @@ subnet_lookup(const uint32_t addr)
     return subnet_entry;
 }
 
-/* Add a subnet-definition - name pair to the set.
- * The definition is taken by masking the address passed in with the mask of the
- * given length.
+/* Add a subnet-definition - name pair to a trie. Only the first mask_length
+ * bits of the address (in network byte order) are used.
  */
 static void
-subnet_entry_set(uint32_t subnet_addr, const uint8_t mask_length, const char* name)
+subnet_trie_insert(subnet_trie_node_t **root, const uint8_t *addr, unsigned mask_length, const char* name)
 {
-    subnet_length_entry_t* entry;
-    sub_net_hashipv4_t * tp;
-    size_t hash_idx;
+    subnet_trie_node_t *node;
+    subnet_name_t *subnet;
+    unsigned level, slot, first, count;
 
-    ws_assert(mask_length > 0 && mask_length <= 32);
+    ws_assert(mask_length > 0);
 
-    entry = &subnet_length_entries[mask_length - 1];
+    if (*root == NULL)
+        *root = wmem_new0(addr_resolv_scope, subnet_trie_node_t);
+    node = *root;
 
-    subnet_addr &= entry->mask;
-
-    hash_idx = HASH_IPV4_ADDRESS(subnet_addr);
-
-    if (NULL == entry->subnet_addresses) {
-        entry->subnet_addresses = (sub_net_hashipv4_t**)wmem_alloc0(addr_resolv_scope, sizeof(sub_net_hashipv4_t*) * HASHHOSTSIZE);
+    /* Go down to the level with the last bits of the subnet */
+    for (level = 0; (level + 1) * SUBNET_TRIE_STRIDE < mask_length; level++) {
+        slot = subnet_trie_slot(addr, level);
+        if (node->children[slot] == NULL)
+            node->children[slot] = wmem_new0(addr_resolv_scope, subnet_trie_node_t);
+        node = node->children[slot];
     }
 
-    if (NULL != (tp = entry->subnet_addresses[hash_idx])) {
-        sub_net_hashipv4_t * new_tp;
+    /* The subnet covers the slots that start with its remaining bits */
+    count = 1U << ((level + 1) * SUBNET_TRIE_STRIDE - mask_length);
+    first = subnet_trie_slot(addr, level) & ~(count - 1);
 
-        while (tp->next) {
-            if (tp->addr == subnet_addr) {
-                return; /* XXX provide warning that an address was repeated? */
-            } else {
-                tp = tp->next;
-            }
-        }
+    /* Any other subnet of the same length here is the same subnet */
+    if (node->subnets[first] != NULL && node->subnets[first]->mask_length == mask_length)
+        return; /* XXX provide warning that an address was repeated? */
 
-        new_tp = wmem_new(addr_resolv_scope, sub_net_hashipv4_t);
-        tp->next = new_tp;
-        tp = new_tp;
-    } else {
-        tp = entry->subnet_addresses[hash_idx] = wmem_new(addr_resolv_scope, sub_net_hashipv4_t);
+    subnet = wmem_new(addr_resolv_scope, subnet_name_t);
+    subnet->mask_length = mask_length;
+    (void) g_strlcpy(subnet->name, name, MAXNAMELEN); /* This is longer than subnet names can actually be */
+    subnet->next = subnet_names;
+    subnet_names = subnet;
+
+    for (slot = first; slot < first + count; slot++) {
+        if (node->subnets[slot] == NULL || node->subnets[slot]->mask_length < mask_length)
+            node->subnets[slot] = subnet;
     }
+}
+
+static void
+subnet_trie_free(subnet_trie_node_t *node)
+{
+    unsigned slot;
+
+    if (node == NULL)
+        return;
 
-    tp->next = NULL;
-    tp->addr = subnet_addr;
-    (void) g_strlcpy(tp->name, name, MAXNAMELEN); /* This is longer than subnet names can actually be */
-    have_subnet_entry = true;
+    for (slot = 0; slot < SUBNET_TRIE_SLOTS; slot++)
+        subnet_trie_free(node->children[slot]);
+    wmem_free(addr_resolv_scope, node);
 }
 
 static void
 subnet_name_lookup_init(void)
 {
     char* subnetspath;
-    uint32_t i;
-
-    for(i = 0; i < SUBNETLENGTHSIZE; ++i) {
-        uint32_t length = i + 1;
-
-        subnet_length_entries[i].subnet_addresses  = NULL;
-        subnet_length_entries[i].mask_length  = length;
-        subnet_length_entries[i].mask = g_htonl(ws_ipv4_get_subnet_mask(length));
-    }
 
     /* Check profile directory before personal configuration */
     subnetspath = get_persconffile_path(ENAME_SUBNETS, true);
@@ -3275,6 +3563,25 @@ addr_resolve_pref_init(module_t *nameres)
             10,
             &name_resolve_concurrency);
 
+    prefs_register_bool_preference(nameres, "use_dns_cache",
+            "Keep DNS results between runs",
+            "Save the results of reverse DNS lookups in the \"" ENAME_DNS_CACHE "\" file"
+            " in the personal configuration directory, and use them instead of"
+            " looking the addresses up again until they expire.",
+            &use_dns_cache);
+
+    prefs_register_uint_preference(nameres, "dns_cache_lifetime",
+            "DNS cache lifetime (hours)",
+            "How long a name found by a reverse DNS lookup is kept.",
+            10,
+            &dns_cache_lifetime);
+
+    prefs_register_uint_preference(nameres, "dns_cache_negative_lifetime",
+            "DNS cache lifetime for unknown addresses (minutes)",
+            "How long to remember that an address has no name.",
+            10,
+            &dns_cache_negative_lifetime);
+
     prefs_register_obsolete_preference(nameres, "hosts_file_handling");
 
     prefs_register_bool_preference(nameres, "vlan_name",
@@ -3554,31 +3861,27 @@ host_name_lookup_init(void)
 static void
 host_name_lookup_cleanup(void)
 {
-    uint32_t i, j;
-    sub_net_hashipv4_t *entry, *next_entry;
+    subnet_name_t *subnet, *next_subnet;
 
     _host_name_lookup_cleanup();
 
+    dns_cache_write();
+
     ipxnet_hash_table = NULL;
     ipv4_hash_table = NULL;
     ipv6_hash_table = NULL;
     ss7pc_hash_table = NULL;
 
-    for(i = 0; i < SUBNETLENGTHSIZE; ++i) {
-        if (subnet_length_entries[i].subnet_addresses != NULL) {
-            for (j = 0; j < HASHHOSTSIZE; j++) {
-                for (entry = subnet_length_entries[i].subnet_addresses[j];
-                     entry != NULL; entry = next_entry) {
-                    next_entry = entry->next;
-                    wmem_free(addr_resolv_scope, entry);
-                }
-            }
-            wmem_free(addr_resolv_scope, subnet_length_entries[i].subnet_addresses);
-            subnet_length_entries[i].subnet_addresses = NULL;
-        }
+    subnet_trie_free(subnet_trie_ipv4);
+    subnet_trie_ipv4 = NULL;
+    subnet_trie_free(subnet_trie_ipv6);
+    subnet_trie_ipv6 = NULL;
+    for (subnet = subnet_names; subnet != NULL; subnet = next_subnet) {
+        next_subnet = subnet->next;
+        wmem_free(addr_resolv_scope, subnet);
     }
+    subnet_names = NULL;
 
-    have_subnet_entry = false;
     new_resolved_objects = false;
 }
 
@@ -1022,6 +1022,55 @@ get_default_timestamp_precision(void)
   return tsprecision;
 }
 
+/*
+ * Converting a time stamp to broken-down time is comparatively slow,
+ * especially for local time, and packets usually arrive many to the
+ * second, so remember the last conversion.
+ */
+static struct tm *
+col_time_to_tm(time_t secs, bool local)
+{
+  static struct tm local_tm, utc_tm;
+  static time_t local_secs, utc_secs;
+  static bool local_valid, utc_valid;
+
+  if (local) {
+    if (!local_valid || secs != local_secs) {
+      local_valid = ws_localtime_r(&secs, &local_tm) != NULL;
+      local_secs = secs;
+    }
+    return local_valid ? &local_tm : NULL;
+  }
+
+  if (!utc_valid || secs != utc_secs) {
+    utc_valid = ws_gmtime_r(&secs, &utc_tm) != NULL;
+    utc_secs = secs;
+  }
+  return utc_valid ? &utc_tm : NULL;
+}
+
+/* Write a value from 0 to 99 as two digits, without a terminating '\0'. */
+static inline char *
+col_put_2digits(char *ptr, int value)
+{
+  *ptr++ = '0' + value / 10;
+  *ptr++ = '0' + value % 10;
+  return ptr;
+}
+
+/* Write "HH:MM:SS", without a terminating '\0'. */
+static inline char *
+col_put_hms(char *ptr, const struct tm *tmp)
+{
+  ptr = col_put_2digits(ptr, tmp->tm_hour);
+  *ptr++ = ':';
+  ptr = col_put_2digits(ptr, tmp->tm_min);
+  *ptr++ = ':';
+  /* tm_sec can be 60 for a leap second */
+  ptr = col_put_2digits(ptr, tmp->tm_sec);
+  return ptr;
+}
+
 static void
 set_abs_ymd_time(const frame_data *fd, char *buf, char *decimal_point, bool local)
 {
@@ -1033,21 +1082,25 @@ set_abs_ymd_time(const frame_data *fd, char *buf, char *decimal_point, bool loca
 }
 
 static void
-col_set_abs_ymd_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_abs_ymd_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   set_abs_ymd_time(fd, cinfo->columns[col].col_buf, col_decimal_point, true);
-  cinfo->col_expr.col_expr[col] = "frame.time";
-  (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  if (fill_col_exprs) {
+    cinfo->col_expr.col_expr[col] = "frame.time";
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  }
 
   cinfo->columns[col].col_data = cinfo->columns[col].col_buf;
 }
 
 static void
-col_set_utc_ymd_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_utc_ymd_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   set_abs_ymd_time(fd, cinfo->columns[col].col_buf, col_decimal_point, false);
-  cinfo->col_expr.col_expr[col] = "frame.time";
-  (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  if (fill_col_exprs) {
+    cinfo->col_expr.col_expr[col] = "frame.time";
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  }
 
   cinfo->columns[col].col_data = cinfo->columns[col].col_buf;
 }
@@ -1055,7 +1108,7 @@ col_set_utc_ymd_time(const frame_data *fd, column_info *cinfo, const int col)
 static void
 set_abs_ydoy_time(const frame_data *fd, char *buf, char *decimal_point, bool local)
 {
-  struct tm tm, *tmp;
+  struct tm *tmp;
   char *ptr;
   size_t remaining;
   int num_bytes;
@@ -1066,22 +1119,16 @@ set_abs_ydoy_time(const frame_data *fd, char *buf, char *decimal_point, bool loc
     return;
   }
 
-  if (local)
-    tmp = ws_localtime_r(&fd->abs_ts.secs, &tm);
-  else
-    tmp = ws_gmtime_r(&fd->abs_ts.secs, &tm);
+  tmp = col_time_to_tm(fd->abs_ts.secs, local);
   if (tmp == NULL) {
     snprintf(buf, COL_MAX_LEN, "Not representable");
     return;
   }
   ptr = buf;
   remaining = COL_MAX_LEN;
-  num_bytes = snprintf(ptr, remaining,"%04d/%03d %02d:%02d:%02d",
+  num_bytes = snprintf(ptr, remaining,"%04d/%03d ",
     tmp->tm_year + 1900,
-    tmp->tm_yday + 1,
-    tmp->tm_hour,
-    tmp->tm_min,
-    tmp->tm_sec);
+    tmp->tm_yday + 1);
   if (num_bytes < 0) {
     /*
      * That got an error.
@@ -1090,7 +1137,7 @@ set_abs_ydoy_time(const frame_data *fd, char *buf, char *decimal_point, bool loc
     snprintf(ptr, remaining, "snprintf() failed");
     return;
   }
-  if ((unsigned int)num_bytes >= remaining) {
+  if ((unsigned int)num_bytes + 8 >= remaining) {
     /*
      * That filled up or would have overflowed the buffer.
      * Nothing more we can do.
@@ -1098,7 +1145,9 @@ set_abs_ydoy_time(const frame_data *fd, char *buf, char *decimal_point, bool loc
     return;
   }
   ptr += num_bytes;
-  remaining -= num_bytes;
+  ptr = col_put_hms(ptr, tmp);
+  *ptr = '\0';
+  remaining -= num_bytes + 8;
 
   tsprecision = get_frame_timestamp_precision(fd);
   if (tsprecision != 0) {
@@ -1112,21 +1161,25 @@ set_abs_ydoy_time(const frame_data *fd, char *buf, char *decimal_point, bool loc
 }
 
 static void
-col_set_abs_ydoy_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_abs_ydoy_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   set_abs_ydoy_time(fd, cinfo->columns[col].col_buf, col_decimal_point, true);
-  cinfo->col_expr.col_expr[col] = "frame.time";
-  (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  if (fill_col_exprs) {
+    cinfo->col_expr.col_expr[col] = "frame.time";
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  }
 
   cinfo->columns[col].col_data = cinfo->columns[col].col_buf;
 }
 
 static void
-col_set_utc_ydoy_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_utc_ydoy_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   set_abs_ydoy_time(fd, cinfo->columns[col].col_buf, col_decimal_point, false);
-  cinfo->col_expr.col_expr[col] = "frame.time";
-  (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  if (fill_col_exprs) {
+    cinfo->col_expr.col_expr[col] = "frame.time";
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  }
 
   cinfo->columns[col].col_data = cinfo->columns[col].col_buf;
 }
@@ -1241,7 +1294,7 @@ set_time_hour_min_sec(const frame_data *fd, const nstime_t *ts, char *buf, char
 }
 
 static void
-col_set_rel_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_rel_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   nstime_t del_rel_ts;
 
@@ -1255,13 +1308,17 @@ col_set_rel_time(const frame_data *fd, column_info *cinfo, const int col)
   switch (timestamp_get_seconds_type()) {
   case TS_SECONDS_DEFAULT:
     set_time_seconds(fd, &del_rel_ts, cinfo->columns[col].col_buf);
-    cinfo->col_expr.col_expr[col] = "frame.time_relative";
-    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+    if (fill_col_exprs) {
+      cinfo->col_expr.col_expr[col] = "frame.time_relative";
+      (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+    }
     break;
   case TS_SECONDS_HOUR_MIN_SEC:
     set_time_hour_min_sec(fd, &del_rel_ts, cinfo->columns[col].col_buf, col_decimal_point);
-    cinfo->col_expr.col_expr[col] = "frame.time_relative";
-    set_time_seconds(fd, &del_rel_ts, cinfo->col_expr.col_expr_val[col]);
+    if (fill_col_exprs) {
+      cinfo->col_expr.col_expr[col] = "frame.time_relative";
+      set_time_seconds(fd, &del_rel_ts, cinfo->col_expr.col_expr_val[col]);
+    }
     break;
   default:
     ws_assert_not_reached();
@@ -1270,7 +1327,7 @@ col_set_rel_time(const frame_data *fd, column_info *cinfo, const int col)
 }
 
 static void
-col_set_delta_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_delta_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   nstime_t del_cap_ts;
 
@@ -1284,13 +1341,17 @@ col_set_delta_time(const frame_data *fd, column_info *cinfo, const int col)
   switch (timestamp_get_seconds_type()) {
   case TS_SECONDS_DEFAULT:
     set_time_seconds(fd, &del_cap_ts, cinfo->columns[col].col_buf);
-    cinfo->col_expr.col_expr[col] = "frame.time_delta";
-    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+    if (fill_col_exprs) {
+      cinfo->col_expr.col_expr[col] = "frame.time_delta";
+      (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+    }
     break;
   case TS_SECONDS_HOUR_MIN_SEC:
     set_time_hour_min_sec(fd, &del_cap_ts, cinfo->columns[col].col_buf, col_decimal_point);
-    cinfo->col_expr.col_expr[col] = "frame.time_delta";
-    set_time_seconds(fd, &del_cap_ts, cinfo->col_expr.col_expr_val[col]);
+    if (fill_col_exprs) {
+      cinfo->col_expr.col_expr[col] = "frame.time_delta";
+      set_time_seconds(fd, &del_cap_ts, cinfo->col_expr.col_expr_val[col]);
+    }
     break;
   default:
     ws_assert_not_reached();
@@ -1300,7 +1361,7 @@ col_set_delta_time(const frame_data *fd, column_info *cinfo, const int col)
 }
 
 static void
-col_set_delta_time_dis(const frame_data *fd, column_info *cinfo, const int col)
+col_set_delta_time_dis(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   nstime_t del_dis_ts;
 
@@ -1314,13 +1375,17 @@ col_set_delta_time_dis(const frame_data *fd, column_info *cinfo, const int col)
   switch (timestamp_get_seconds_type()) {
   case TS_SECONDS_DEFAULT:
     set_time_seconds(fd, &del_dis_ts, cinfo->columns[col].col_buf);
-    cinfo->col_expr.col_expr[col] = "frame.time_delta_displayed";
-    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+    if (fill_col_exprs) {
+      cinfo->col_expr.col_expr[col] = "frame.time_delta_displayed";
+      (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+    }
     break;
   case TS_SECONDS_HOUR_MIN_SEC:
     set_time_hour_min_sec(fd, &del_dis_ts, cinfo->columns[col].col_buf, col_decimal_point);
-    cinfo->col_expr.col_expr[col] = "frame.time_delta_displayed";
-    set_time_seconds(fd, &del_dis_ts, cinfo->col_expr.col_expr_val[col]);
+    if (fill_col_exprs) {
+      cinfo->col_expr.col_expr[col] = "frame.time_delta_displayed";
+      set_time_seconds(fd, &del_dis_ts, cinfo->col_expr.col_expr_val[col]);
+    }
     break;
   default:
     ws_assert_not_reached();
@@ -1335,10 +1400,9 @@ col_set_delta_time_dis(const frame_data *fd, column_info *cinfo, const int col)
 static void
 set_abs_time(const frame_data *fd, char *buf, char *decimal_point, bool local)
 {
-  struct tm tm, *tmp;
+  struct tm *tmp;
   char *ptr;
   size_t remaining;
-  int num_bytes;
   int tsprecision;
 
   if (!fd->has_ts) {
@@ -1349,37 +1413,16 @@ set_abs_time(const frame_data *fd, char *buf, char *decimal_point, bool local)
   ptr = buf;
   remaining = COL_MAX_LEN;
 
-  if (local)
-    tmp = ws_localtime_r(&fd->abs_ts.secs, &tm);
-  else
-    tmp = ws_gmtime_r(&fd->abs_ts.secs, &tm);
+  tmp = col_time_to_tm(fd->abs_ts.secs, local);
   if (tmp == NULL) {
     snprintf(ptr, remaining, "Not representable");
     return;
   }
 
-  /* Integral part. */
-  num_bytes = snprintf(ptr, remaining, "%02d:%02d:%02d",
-    tmp->tm_hour,
-    tmp->tm_min,
-    tmp->tm_sec);
-  if (num_bytes < 0) {
-    /*
-     * That got an error.
-     * Not much else we can do.
-     */
-    snprintf(ptr, remaining, "snprintf() failed");
-    return;
-  }
-  if ((unsigned int)num_bytes >= remaining) {
-    /*
-     * That filled up or would have overflowed the buffer.
-     * Nothing more we can do.
-     */
-    return;
-  }
-  ptr += num_bytes;
-  remaining -= num_bytes;
+  /* Integral part; COL_MAX_LEN always has room for it. */
+  ptr = col_put_hms(ptr, tmp);
+  *ptr = '\0';
+  remaining -= 8;
 
   tsprecision = get_frame_timestamp_precision(fd);
   if (tsprecision != 0) {
@@ -1393,21 +1436,25 @@ set_abs_time(const frame_data *fd, char *buf, char *decimal_point, bool local)
 }
 
 static void
-col_set_abs_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_abs_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   set_abs_time(fd, cinfo->columns[col].col_buf, col_decimal_point, true);
-  cinfo->col_expr.col_expr[col] = "frame.time";
-  (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  if (fill_col_exprs) {
+    cinfo->col_expr.col_expr[col] = "frame.time";
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  }
 
   cinfo->columns[col].col_data = cinfo->columns[col].col_buf;
 }
 
 static void
-col_set_utc_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_utc_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   set_abs_time(fd, cinfo->columns[col].col_buf, col_decimal_point, false);
-  cinfo->col_expr.col_expr[col] = "frame.time";
-  (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  if (fill_col_exprs) {
+    cinfo->col_expr.col_expr[col] = "frame.time";
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
+  }
 
   cinfo->columns[col].col_data = cinfo->columns[col].col_buf;
 }
@@ -1424,9 +1471,9 @@ set_epoch_time(const frame_data *fd, char *buf)
 }
 
 static void
-col_set_epoch_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_epoch_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
-  if (set_epoch_time(fd, cinfo->columns[col].col_buf)) {
+  if (set_epoch_time(fd, cinfo->columns[col].col_buf) && fill_col_exprs) {
     cinfo->col_expr.col_expr[col] = "frame.time_delta";
     (void) g_strlcpy(cinfo->col_expr.col_expr_val[col],cinfo->columns[col].col_buf,COL_MAX_LEN);
   }
@@ -1537,47 +1584,47 @@ set_fd_time(const epan_t *epan, frame_data *fd, char *buf)
 }
 
 static void
-col_set_cls_time(const frame_data *fd, column_info *cinfo, const int col)
+col_set_cls_time(const frame_data *fd, column_info *cinfo, const int col, const bool fill_col_exprs)
 {
   switch (timestamp_get_type()) {
   case TS_ABSOLUTE:
-    col_set_abs_time(fd, cinfo, col);
+    col_set_abs_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_ABSOLUTE_WITH_YMD:
-    col_set_abs_ymd_time(fd, cinfo, col);
+    col_set_abs_ymd_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_ABSOLUTE_WITH_YDOY:
-    col_set_abs_ydoy_time(fd, cinfo, col);
+    col_set_abs_ydoy_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_RELATIVE:
-    col_set_rel_time(fd, cinfo, col);
+    col_set_rel_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_DELTA:
-    col_set_delta_time(fd, cinfo, col);
+    col_set_delta_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_DELTA_DIS:
-    col_set_delta_time_dis(fd, cinfo, col);
+    col_set_delta_time_dis(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_EPOCH:
-    col_set_epoch_time(fd, cinfo, col);
+    col_set_epoch_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_UTC:
-    col_set_utc_time(fd, cinfo, col);
+    col_set_utc_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_UTC_WITH_YMD:
-    col_set_utc_ymd_time(fd, cinfo, col);
+    col_set_utc_ymd_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_UTC_WITH_YDOY:
-    col_set_utc_ydoy_time(fd, cinfo, col);
+    col_set_utc_ydoy_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case TS_NOT_SET:
@@ -1589,49 +1636,49 @@ col_set_cls_time(const frame_data *fd, column_info *cinfo, const int col)
 
 /* Set the format of the variable time format. */
 static void
-col_set_fmt_time(const frame_data *fd, column_info *cinfo, const int fmt, const int col)
+col_set_fmt_time(const frame_data *fd, column_info *cinfo, const int fmt, const int col, const bool fill_col_exprs)
 {
   COL_CHECK_REF_TIME(fd, cinfo->columns[col].col_buf);
 
   switch (fmt) {
   case COL_CLS_TIME:
-    col_set_cls_time(fd, cinfo, col);
+    col_set_cls_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_ABS_TIME:
-    col_set_abs_time(fd, cinfo, col);
+    col_set_abs_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_ABS_YMD_TIME:
-    col_set_abs_ymd_time(fd, cinfo, col);
+    col_set_abs_ymd_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_ABS_YDOY_TIME:
-    col_set_abs_ydoy_time(fd, cinfo, col);
+    col_set_abs_ydoy_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_REL_TIME:
-    col_set_rel_time(fd, cinfo, col);
+    col_set_rel_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_DELTA_TIME:
-    col_set_delta_time(fd, cinfo, col);
+    col_set_delta_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_DELTA_TIME_DIS:
-    col_set_delta_time_dis(fd, cinfo, col);
+    col_set_delta_time_dis(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_UTC_TIME:
-    col_set_utc_time(fd, cinfo, col);
+    col_set_utc_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_UTC_YMD_TIME:
-    col_set_utc_ymd_time(fd, cinfo, col);
+    col_set_utc_ymd_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   case COL_UTC_YDOY_TIME:
-    col_set_utc_ydoy_time(fd, cinfo, col);
+    col_set_utc_ydoy_time(fd, cinfo, col, fill_col_exprs);
     break;
 
   default:
@@ -1847,8 +1894,7 @@ col_fill_in_frame_data(const frame_data *fd, column_info *cinfo, const int col,
   case COL_REL_TIME:
   case COL_DELTA_TIME:
   case COL_DELTA_TIME_DIS:
-    /* TODO: Pass on fill_col_exprs */
-    col_set_fmt_time(fd, cinfo, col_item->col_fmt, col);
+    col_set_fmt_time(fd, cinfo, col_item->col_fmt, col, fill_col_exprs);
     break;
 
   case COL_PACKET_LENGTH:
@@ -104,6 +104,17 @@ extern const uint32_t crc32_table[256];
 /****************************************************************************/
 /*      Type definitions                                                        */
 
+/* Passphrase-to-PSK mappings computed so far, keyed by the SSID length,
+ * SSID and passphrase. Deriving a PSK takes 8192 HMAC-SHA1 operations;
+ * wildcard SSID keys are derived again for every SSID they're tried
+ * with, and all keys are derived again whenever the key list is set.
+ * The cache is kept across Dot11DecryptInitContext() so that reloading
+ * a capture or changing unrelated keys doesn't redo the work. */
+static GHashTable *psk_cache;
+
+/* Upper bound on the number of cached PSKs. */
+#define PSK_CACHE_MAX_ENTRIES 4096
+
 /*      Internal function prototype declarations                                */
 
 #ifdef  __cplusplus
@@ -1193,6 +1204,11 @@ int Dot11DecryptDestroyContext(
     Dot11DecryptCleanKeys(ctx);
     Dot11DecryptCleanSecAssoc(ctx);
 
+    if (psk_cache != NULL) {
+        g_hash_table_destroy(psk_cache);
+        psk_cache = NULL;
+    }
+
     ws_debug("Context destroyed!");
     return DOT11DECRYPT_RET_SUCCESS;
 }
@@ -2662,6 +2678,7 @@ Dot11DecryptRsnaPwd2PskStep(
     unsigned char *output)
 {
     unsigned char digest[MAX_SSID_LENGTH+4] = { 0 };  /* SSID plus 4 bytes of count */
+    gcry_md_hd_t hmac_handle;
     int i, j;
 
     if (ssidLength > MAX_SSID_LENGTH) {
@@ -2669,23 +2686,33 @@ Dot11DecryptRsnaPwd2PskStep(
         return DOT11DECRYPT_RET_UNSUCCESS;
     }
 
+    /* Every iteration uses the passphrase as the HMAC key, so set it
+     * once and reset the handle between iterations instead of opening
+     * a new one each time. */
+    if (gcry_md_open(&hmac_handle, GCRY_MD_SHA1, GCRY_MD_FLAG_HMAC)) {
+        return DOT11DECRYPT_RET_UNSUCCESS;
+    }
+    if (gcry_md_setkey(hmac_handle, ppBytes, ppLength)) {
+        gcry_md_close(hmac_handle);
+        return DOT11DECRYPT_RET_UNSUCCESS;
+    }
+
     /* U1 = PRF(P, S || int(i)) */
     memcpy(digest, ssid, ssidLength);
     digest[ssidLength] = (unsigned char)((count>>24) & 0xff);
     digest[ssidLength+1] = (unsigned char)((count>>16) & 0xff);
     digest[ssidLength+2] = (unsigned char)((count>>8) & 0xff);
     digest[ssidLength+3] = (unsigned char)(count & 0xff);
-    if (ws_hmac_buffer(GCRY_MD_SHA1, digest, digest, (uint32_t) ssidLength + 4, ppBytes, ppLength)) {
-      return DOT11DECRYPT_RET_UNSUCCESS;
-    }
+    gcry_md_write(hmac_handle, digest, ssidLength + 4);
+    memcpy(digest, gcry_md_read(hmac_handle, 0), HASH_SHA1_LENGTH);
 
     /* output = U1 */
     memcpy(output, digest, 20);
     for (i = 1; i < iterations; i++) {
         /* Un = PRF(P, Un-1) */
-        if (ws_hmac_buffer(GCRY_MD_SHA1, digest, digest, HASH_SHA1_LENGTH, ppBytes, ppLength)) {
-          return DOT11DECRYPT_RET_UNSUCCESS;
-        }
+        gcry_md_reset(hmac_handle);
+        gcry_md_write(hmac_handle, digest, HASH_SHA1_LENGTH);
+        memcpy(digest, gcry_md_read(hmac_handle, 0), HASH_SHA1_LENGTH);
 
         /* output = output xor Un */
         for (j = 0; j < 20; j++) {
@@ -2693,24 +2720,61 @@ Dot11DecryptRsnaPwd2PskStep(
         }
     }
 
+    gcry_md_close(hmac_handle);
     return DOT11DECRYPT_RET_SUCCESS;
 }
 
+static GBytes *
+Dot11DecryptPskCacheKey(const struct DOT11DECRYPT_KEY_ITEMDATA_PWD *userPwd)
+{
+    GByteArray *key_ba = g_byte_array_sized_new((unsigned)(1 + userPwd->SsidLen + userPwd->PassphraseLen));
+    uint8_t ssid_len = (uint8_t)userPwd->SsidLen;
+
+    g_byte_array_append(key_ba, &ssid_len, 1);
+    g_byte_array_append(key_ba, (const uint8_t *)userPwd->Ssid, (unsigned)userPwd->SsidLen);
+    g_byte_array_append(key_ba, (const uint8_t *)userPwd->Passphrase, (unsigned)userPwd->PassphraseLen);
+
+    return g_byte_array_free_to_bytes(key_ba);
+}
+
 static int
 Dot11DecryptRsnaPwd2Psk(
     const struct DOT11DECRYPT_KEY_ITEMDATA_PWD *userPwd,
     unsigned char *output)
 {
     unsigned char m_output[40] = { 0 };
-    GByteArray *pp_ba = g_byte_array_new();
+    GBytes *cache_key;
+    unsigned char *cached_psk;
 
-    g_byte_array_append(pp_ba, userPwd->Passphrase, (unsigned)userPwd->PassphraseLen);
+    if (psk_cache == NULL) {
+        psk_cache = g_hash_table_new_full(g_bytes_hash, g_bytes_equal,
+                                          (GDestroyNotify)g_bytes_unref, g_free);
+    }
 
-    Dot11DecryptRsnaPwd2PskStep(pp_ba->data, pp_ba->len, userPwd->Ssid, userPwd->SsidLen, 4096, 1, m_output);
-    Dot11DecryptRsnaPwd2PskStep(pp_ba->data, pp_ba->len, userPwd->Ssid, userPwd->SsidLen, 4096, 2, &m_output[20]);
+    cache_key = Dot11DecryptPskCacheKey(userPwd);
+    cached_psk = (unsigned char *)g_hash_table_lookup(psk_cache, cache_key);
+    if (cached_psk != NULL) {
+        memcpy(output, cached_psk, DOT11DECRYPT_WPA_PWD_PSK_LEN);
+        g_bytes_unref(cache_key);
+        return 0;
+    }
+
+    if (Dot11DecryptRsnaPwd2PskStep((const uint8_t *)userPwd->Passphrase, (unsigned)userPwd->PassphraseLen,
+                                    userPwd->Ssid, userPwd->SsidLen, 4096, 1, m_output) != DOT11DECRYPT_RET_SUCCESS ||
+        Dot11DecryptRsnaPwd2PskStep((const uint8_t *)userPwd->Passphrase, (unsigned)userPwd->PassphraseLen,
+                                    userPwd->Ssid, userPwd->SsidLen, 4096, 2, &m_output[20]) != DOT11DECRYPT_RET_SUCCESS) {
+        /* Don't cache a failed derivation. */
+        memcpy(output, m_output, DOT11DECRYPT_WPA_PWD_PSK_LEN);
+        g_bytes_unref(cache_key);
+        return 0;
+    }
 
     memcpy(output, m_output, DOT11DECRYPT_WPA_PWD_PSK_LEN);
-    g_byte_array_free(pp_ba, true);
+
+    if (g_hash_table_size(psk_cache) >= PSK_CACHE_MAX_ENTRIES) {
+        g_hash_table_remove_all(psk_cache);
+    }
+    g_hash_table_insert(psk_cache, cache_key, g_memdup2(m_output, DOT11DECRYPT_WPA_PWD_PSK_LEN));
 
     return 0;
 }
@@ -288,6 +288,23 @@ static extra_esp_sa_records_t extra_esp_sa_records;
 static uat_t * esp_uat;
 static unsigned num_sa_uat;
 
+/* Index of the SAs above, rebuilt when they change. SAs without any
+   wildcards are found with a hash lookup on (protocol, addresses, SPI);
+   only the ones with wildcards are tried in turn. Besides being
+   invalidated by the UAT callbacks, the index is rebuilt if the arrays
+   it points into are not the ones it was built from. */
+typedef struct {
+  bool       valid;
+  uat_esp_sa_record_t *uat_records;   /* uat_esp_sa_records when built */
+  unsigned   num_uat_records;         /* num_sa_uat when built */
+  uat_esp_sa_record_t *extra_records; /* extra_esp_sa_records.records when built */
+  unsigned   num_extra_records;       /* extra_esp_sa_records.num_records when built */
+  GPtrArray *records;     /* uat_esp_sa_record_t *, extra records first, then UAT ones */
+  GHashTable *exact;      /* key string -> index in records + 1 */
+  GArray    *wildcards;   /* unsigned, indexes in records, in increasing order */
+} esp_sa_index_t;
+static esp_sa_index_t esp_sa_index;
+
 /*
    Name : static int compute_ascii_key(char **ascii_key, char *key)
    Description : Allocate memory for the key and transform the key if it is hexadecimal
@@ -430,6 +447,15 @@ static bool uat_esp_sa_record_update_cb(void* r, char** err) {
   return *err == NULL;
 }
 
+static void uat_esp_sa_record_post_update_cb(void) {
+  esp_sa_index.valid = false;
+}
+
+/* uat_clear() frees the records without calling the post update callback */
+static void uat_esp_sa_record_reset_cb(void) {
+  esp_sa_index.valid = false;
+}
+
 static void* uat_esp_sa_record_copy_cb(void* n, const void* o, size_t siz _U_) {
   uat_esp_sa_record_t* new_rec = (uat_esp_sa_record_t *)n;
   const uat_esp_sa_record_t* old_rec = (const uat_esp_sa_record_t *)o;
@@ -543,6 +569,8 @@ void esp_sa_record_add_from_dissector(uint8_t protocol, const char *srcIP, const
        /* Free (but ignore) any error string set */
        g_free(err);
    }
+
+   esp_sa_index.valid = false;
 }
 
 /*************************************/
@@ -1110,6 +1138,147 @@ filter_spi_match(unsigned spi, char *filter)
 }
 
 
+/* Expand an address (or address filter) to hex digits, as used for matching. */
+static bool
+esp_sa_expand_address(char *addr_hex, char *addr, int typ)
+{
+  if (typ == IPSEC_SA_IPV4)
+    return get_full_ipv4_addr(addr_hex, addr);
+  else
+    return get_full_ipv6_addr(addr_hex, addr) == 0;
+}
+
+/* Build the key of an SA in the exact match table. */
+static void
+esp_sa_index_key(char *key, size_t key_size, int typ, const char *src_hex, const char *dst_hex, unsigned spi)
+{
+  snprintf(key, key_size, "%d|%s|%s|%08x", typ, src_hex, dst_hex, spi);
+}
+
+#define ESP_SA_INDEX_KEY_LEN (2 * (IPSEC_STRLEN_IPV6 + 1) + 12)
+
+/* Check whether an SA matches exactly one (protocol, addresses, SPI)
+   combination and, if so, get its key in the exact match table. */
+static bool
+esp_sa_record_exact_key(const uat_esp_sa_record_t *record, char *key, size_t key_size)
+{
+  char src_hex[IPSEC_STRLEN_IPV6 + 1];
+  char dst_hex[IPSEC_STRLEN_IPV6 + 1];
+  size_t full_len = (record->protocol == IPSEC_SA_IPV4) ? IPSEC_STRLEN_IPV4 : IPSEC_STRLEN_IPV6;
+  unsigned long spi;
+
+  if (!record->srcIP || !record->dstIP || !record->spi)
+    return false;
+  if (record->protocol != IPSEC_SA_IPV4 && record->protocol != IPSEC_SA_IPV6)
+    return false;
+  if (!esp_sa_expand_address(src_hex, record->srcIP, record->protocol) ||
+      strlen(src_hex) != full_len || strchr(src_hex, IPSEC_SA_WILDCARDS_ANY) != NULL)
+    return false;
+  if (!esp_sa_expand_address(dst_hex, record->dstIP, record->protocol) ||
+      strlen(dst_hex) != full_len || strchr(dst_hex, IPSEC_SA_WILDCARDS_ANY) != NULL)
+    return false;
+  if (strchr(record->spi, IPSEC_SA_WILDCARDS_ANY) != NULL)
+    return false;
+  spi = strtoul(record->spi, NULL, 0);
+  if (spi > UINT32_MAX)
+    return false;
+
+  esp_sa_index_key(key, key_size, record->protocol, src_hex, dst_hex, (unsigned)spi);
+  return true;
+}
+
+static void
+esp_sa_index_build(void)
+{
+  char key[ESP_SA_INDEX_KEY_LEN];
+  unsigned i;
+
+  if (esp_sa_index.records == NULL) {
+    esp_sa_index.records = g_ptr_array_new();
+    esp_sa_index.exact = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    esp_sa_index.wildcards = g_array_new(false, false, sizeof(unsigned));
+  } else {
+    g_ptr_array_set_size(esp_sa_index.records, 0);
+    g_hash_table_remove_all(esp_sa_index.exact);
+    g_array_set_size(esp_sa_index.wildcards, 0);
+  }
+
+  /* Extra ones are checked first */
+  for (i = 0; i < extra_esp_sa_records.num_records; i++)
+    g_ptr_array_add(esp_sa_index.records, &extra_esp_sa_records.records[i]);
+  for (i = 0; i < num_sa_uat; i++)
+    g_ptr_array_add(esp_sa_index.records, &uat_esp_sa_records[i]);
+
+  for (i = 0; i < esp_sa_index.records->len; i++) {
+    uat_esp_sa_record_t *record = (uat_esp_sa_record_t *)g_ptr_array_index(esp_sa_index.records, i);
+    if (record->encryption_key_length == -1 || record->authentication_key_length == -1) {
+      /* Bad key; such an SA is passed over when looking for a match. */
+      continue;
+    }
+    if (esp_sa_record_exact_key(record, key, sizeof(key))) {
+      /* The first SA with a given key wins, as with a linear search. */
+      if (!g_hash_table_contains(esp_sa_index.exact, key))
+        g_hash_table_insert(esp_sa_index.exact, g_strdup(key), GUINT_TO_POINTER(i + 1));
+    } else {
+      g_array_append_val(esp_sa_index.wildcards, i);
+    }
+  }
+
+  esp_sa_index.uat_records = uat_esp_sa_records;
+  esp_sa_index.num_uat_records = num_sa_uat;
+  esp_sa_index.extra_records = extra_esp_sa_records.records;
+  esp_sa_index.num_extra_records = extra_esp_sa_records.num_records;
+  esp_sa_index.valid = true;
+}
+
+/* Find the first SA that matches, in the order extra SAs, then UAT ones. */
+static uat_esp_sa_record_t *
+esp_sa_index_lookup(int protocol_typ, char *src, char *dst, unsigned spi)
+{
+  char src_hex[IPSEC_STRLEN_IPV6 + 1];
+  char dst_hex[IPSEC_STRLEN_IPV6 + 1];
+  char key[ESP_SA_INDEX_KEY_LEN];
+  unsigned exact_idx = UINT_MAX;
+  void *value;
+  unsigned i;
+
+  if (!esp_sa_index.valid ||
+      esp_sa_index.uat_records != uat_esp_sa_records ||
+      esp_sa_index.num_uat_records != num_sa_uat ||
+      esp_sa_index.extra_records != extra_esp_sa_records.records ||
+      esp_sa_index.num_extra_records != extra_esp_sa_records.num_records)
+    esp_sa_index_build();
+
+  /* An address that can't be expanded doesn't match any SA. */
+  if (!esp_sa_expand_address(src_hex, src, protocol_typ) ||
+      !esp_sa_expand_address(dst_hex, dst, protocol_typ))
+    return NULL;
+
+  esp_sa_index_key(key, sizeof(key), protocol_typ, src_hex, dst_hex, spi);
+  value = g_hash_table_lookup(esp_sa_index.exact, key);
+  if (value != NULL)
+    exact_idx = GPOINTER_TO_UINT(value) - 1;
+
+  /* An SA with wildcards only wins if it comes before the exact match. */
+  for (i = 0; i < esp_sa_index.wildcards->len; i++) {
+    unsigned idx = g_array_index(esp_sa_index.wildcards, unsigned, i);
+    uat_esp_sa_record_t *record;
+
+    if (idx > exact_idx)
+      break;
+    record = (uat_esp_sa_record_t *)g_ptr_array_index(esp_sa_index.records, idx);
+    if((protocol_typ == record->protocol)
+       && filter_address_match(src, record->srcIP, protocol_typ)
+       && filter_address_match(dst, record->dstIP, protocol_typ)
+       && filter_spi_match(spi, record->spi))
+      return record;
+  }
+
+  if (exact_idx != UINT_MAX)
+    return (uat_esp_sa_record_t *)g_ptr_array_index(esp_sa_index.records, exact_idx);
+  return NULL;
+}
+
 /*
    Name : static goolean get_esp_sa(g_esp_sa_database *sad, int protocol_typ, char *src,  char *dst,  unsigned spi,
            int *encryption_algo,
@@ -1156,65 +1325,48 @@ get_esp_sa(int protocol_typ, char *src,  char *dst,  unsigned spi,
   )
 {
   bool found = false;
-  unsigned i, j;
+  uat_esp_sa_record_t *record;
 
   *cipher_hd = NULL;
   *cipher_hd_created = NULL;
 
-  /* Check each known SA in turn */
-  for (i = 0, j=0; (found == false) && ((i < num_sa_uat) || (j < extra_esp_sa_records.num_records)); )
+  record = esp_sa_index_lookup(protocol_typ, src, dst, spi);
+  if (record != NULL)
   {
-    /* Get the next record to try */
-    uat_esp_sa_record_t *record;
-    if (j < extra_esp_sa_records.num_records) {
-      /* Extra ones checked first */
-      record = &extra_esp_sa_records.records[j++];
+    found = true;
+
+    *encryption_algo = record->encryption_algo;
+    *authentication_algo = record->authentication_algo;
+    *authentication_key = record->authentication_key;
+    if (record->authentication_key_length == -1)
+    {
+      /* Bad key; XXX - report this */
+      *authentication_key_len = 0;
+      found = false;
     }
     else {
-      /* Then UAT ones */
-      record = &uat_esp_sa_records[i++];
+      *authentication_key_len = record->authentication_key_length;
     }
 
-    if((protocol_typ == record->protocol)
-       && filter_address_match(src, record->srcIP, protocol_typ)
-       && filter_address_match(dst, record->dstIP, protocol_typ)
-       && filter_spi_match(spi, record->spi))
+    *encryption_key = record->encryption_key;
+    if (record->encryption_key_length == -1)
     {
-      found = true;
-
-      *encryption_algo = record->encryption_algo;
-      *authentication_algo = record->authentication_algo;
-      *authentication_key = record->authentication_key;
-      if (record->authentication_key_length == -1)
-      {
-        /* Bad key; XXX - report this */
-        *authentication_key_len = 0;
-        found = false;
-      }
-      else {
-        *authentication_key_len = record->authentication_key_length;
-      }
-
-      *encryption_key = record->encryption_key;
-      if (record->encryption_key_length == -1)
-      {
-        /* Bad key; XXX - report this */
-        *encryption_key_len = 0;
-        found = false;
-      }
-      else {
-        *encryption_key_len = record->encryption_key_length;
-      }
+      /* Bad key; XXX - report this */
+      *encryption_key_len = 0;
+      found = false;
+    }
+    else {
+      *encryption_key_len = record->encryption_key_length;
+    }
 
-      /* Tell the caller whether cipher_hd has been created yet and a pointer.
-         Pass pointer to created flag so that caller can set if/when
-         it opens the cipher_hd. */
-      *cipher_hd = &record->cipher_hd;
-      *cipher_hd_created = &record->cipher_hd_created;
+    /* Tell the caller whether cipher_hd has been created yet and a pointer.
+       Pass pointer to created flag so that caller can set if/when
+       it opens the cipher_hd. */
+    *cipher_hd = &record->cipher_hd;
+    *cipher_hd_created = &record->cipher_hd_created;
 
-      *sn_length = record->sn_length;
-      *sn_upper = record->sn_upper;
-    }
+    *sn_length = record->sn_length;
+    *sn_upper = record->sn_upper;
   }
 
   return found;
@@ -1577,8 +1729,8 @@ dissect_esp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
 
 
     /*
-      PARSE the SAD and fill it. It may take some time since it will
-      be called every times an ESP Payload is found.
+      Look up the SA in the SAD. This is done for every ESP Payload,
+      so SAs without wildcards are found through a hash table.
     */
 
     if((sad_is_present = get_esp_sa(protocol_typ, ip_src, ip_dst, spi,
@@ -2508,6 +2660,7 @@ static void ipsec_cleanup_protocol(void)
   g_free(extra_esp_sa_records.records);
   extra_esp_sa_records.records = NULL;
   extra_esp_sa_records.num_records = 0;
+  esp_sa_index.valid = false;
 }
 
 void
@@ -2705,8 +2858,8 @@ proto_register_ipsec(void)
             uat_esp_sa_record_copy_cb,      /* copy callback */
             uat_esp_sa_record_update_cb,    /* update callback */
             uat_esp_sa_record_free_cb,      /* free callback */
-            NULL,                           /* post update callback */
-            NULL,                           /* reset callback */
+            uat_esp_sa_record_post_update_cb, /* post update callback */
+            uat_esp_sa_record_reset_cb,     /* reset callback */
             esp_uat_flds);                  /* UAT field definitions */
 
   static const char *esp_uat_defaults_[] = {
@@ -30,6 +30,7 @@
 #include <epan/proto_data.h>
 #include <epan/tfs.h>
 #include <epan/unit_strings.h>
+#include <epan/stream_frame_index.h>
 
 #include <wsutil/array.h>
 #include <wsutil/utf8_entities.h>
@@ -966,6 +967,7 @@ static dissector_handle_t tcp_opt_unknown_handle;
 static capture_dissector_handle_t tcp_cap_handle;
 
 static uint32_t tcp_stream_count;
+static stream_frame_index_t *tcp_stream_frames;
 static uint32_t mptcp_stream_count;
 
 
@@ -8342,6 +8344,9 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
         item = proto_tree_add_uint(tcp_tree, hf_tcp_stream, tvb, offset, 0, tcpd->stream);
         proto_item_set_generated(item);
         tcpinfo.stream = tcpd->stream;
+        if (!PINFO_FD_VISITED(pinfo)) {
+            stream_frame_index_add(tcp_stream_frames, tcpd->stream, pinfo->num);
+        }
 
         if (tcppd) {
             item = proto_tree_add_uint(tcp_tree, hf_tcp_stream_pnum, tvb, offset, 0, tcppd->pnum);
@@ -10522,6 +10527,7 @@ proto_register_tcp(void)
         &mptcp_intersubflows_retransmission);
 
     register_conversation_table(proto_mptcp, false, mptcpip_conversation_packet, tcpip_endpoint_packet);
+    tcp_stream_frames = stream_frame_index_register("tcp.stream");
     register_follow_stream(proto_tcp, "tcp_follow", tcp_follow_conv_filter, tcp_follow_index_filter, tcp_follow_address_filter,
                             tcp_port_to_display, follow_tcp_tap_listener, get_tcp_stream_count, NULL);
 
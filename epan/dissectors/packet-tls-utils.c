@@ -6721,26 +6721,154 @@ ssl_compile_keyfile_regex(void)
 
 typedef struct ssl_master_key_match_group {
     const char *re_group_name;
-    GHashTable *master_key_ht;
+    size_t      master_key_ht_offset;   /* in ssl_master_key_map_t */
 } ssl_master_key_match_group_t;
 
-void
-tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data, unsigned datalen)
+static const ssl_master_key_match_group_t mk_groups[] = {
+    { "encrypted_pmk",  offsetof(ssl_master_key_map_t, pre_master) },
+    { "session_id",     offsetof(ssl_master_key_map_t, session) },
+    { "client_random",  offsetof(ssl_master_key_map_t, crandom) },
+    { "client_random_pms",  offsetof(ssl_master_key_map_t, pms) },
+    /* TLS 1.3 map from Client Random to derived secret. */
+    { "client_early",       offsetof(ssl_master_key_map_t, tls13_client_early) },
+    { "client_handshake",   offsetof(ssl_master_key_map_t, tls13_client_handshake) },
+    { "server_handshake",   offsetof(ssl_master_key_map_t, tls13_server_handshake) },
+    { "client_appdata",     offsetof(ssl_master_key_map_t, tls13_client_appdata) },
+    { "server_appdata",     offsetof(ssl_master_key_map_t, tls13_server_appdata) },
+    { "early_exporter",     offsetof(ssl_master_key_map_t, tls13_early_exporter) },
+    { "exporter",           offsetof(ssl_master_key_map_t, tls13_exporter) },
+};
+
+static GHashTable *
+ssl_master_key_match_group_ht(const ssl_master_key_map_t *mk_map, unsigned group)
+{
+    return *(GHashTable * const *)((const char *)mk_map + mk_groups[group].master_key_ht_offset);
+}
+
+/*
+ * The secrets read from the keylog file, kept across ssl_common_cleanup()
+ * so that a new capture file or a preference change does not have to
+ * parse the whole file again. Each record is a group index (uint8_t)
+ * followed by the key and the secret, each as a uint32_t length and the
+ * raw bytes. Only records for the complete lines in the first "offset"
+ * bytes of the file are kept; anything after that is read from the file.
+ * The last of those lines is kept as a hash, to tell whether the file
+ * was rewritten in place since.
+ */
+typedef struct {
+    char       *filename;
+    ws_statb64  statb;          /* of the file the records were read from */
+    int64_t     offset;
+    int64_t     last_line_offset;   /* of the line just before offset */
+    uint8_t     last_line_hash[HASH_SHA2_256_LENGTH];
+    GByteArray *records;
+} tls_keylog_index_t;
+
+static tls_keylog_index_t tls_keylog_index;
+
+static void
+tls_keylog_index_record(unsigned group, const StringInfo *key, const StringInfo *secret)
+{
+    uint8_t group8 = (uint8_t)group;
+
+    g_byte_array_append(tls_keylog_index.records, &group8, 1);
+    g_byte_array_append(tls_keylog_index.records, (const uint8_t *)&key->data_len, sizeof(key->data_len));
+    g_byte_array_append(tls_keylog_index.records, key->data, key->data_len);
+    g_byte_array_append(tls_keylog_index.records, (const uint8_t *)&secret->data_len, sizeof(secret->data_len));
+    g_byte_array_append(tls_keylog_index.records, secret->data, secret->data_len);
+}
+
+static const uint8_t *
+tls_keylog_index_read_stringinfo(const uint8_t *p, StringInfo *si)
+{
+    memcpy(&si->data_len, p, sizeof(si->data_len));
+    p += sizeof(si->data_len);
+    si->data = (unsigned char *)wmem_memdup(wmem_file_scope(), p, si->data_len);
+    return p + si->data_len;
+}
+
+/* Populate the secrets map from the index. */
+static void
+tls_keylog_index_replay(const ssl_master_key_map_t *mk_map)
+{
+    const uint8_t *p = tls_keylog_index.records->data;
+    const uint8_t *end = p + tls_keylog_index.records->len;
+
+    while (p < end) {
+        unsigned group = *p++;
+        StringInfo *key = wmem_new(wmem_file_scope(), StringInfo);
+        StringInfo *secret = wmem_new(wmem_file_scope(), StringInfo);
+
+        p = tls_keylog_index_read_stringinfo(p, key);
+        p = tls_keylog_index_read_stringinfo(p, secret);
+        g_hash_table_insert(ssl_master_key_match_group_ht(mk_map, group), key, secret);
+    }
+}
+
+/*
+ * Check whether the last indexed line is still where it was in the file.
+ * This catches a file that was truncated and written again past the
+ * indexed part, which the size alone doesn't show.
+ */
+static bool
+tls_keylog_index_check_last_line(FILE *keylog_file)
+{
+    char buf[1110];
+    uint8_t hash[HASH_SHA2_256_LENGTH];
+
+    if (tls_keylog_index.offset == 0) {
+        return true;
+    }
+    /* Read it the same way ssl_load_keyfile() did. */
+    if (ws_fseek64(keylog_file, tls_keylog_index.last_line_offset, SEEK_SET) != 0 ||
+        fgets(buf, sizeof(buf), keylog_file) == NULL ||
+        ws_ftell64(keylog_file) != tls_keylog_index.offset) {
+        return false;
+    }
+    gcry_md_hash_buffer(GCRY_MD_SHA256, hash, buf, strlen(buf));
+    return memcmp(hash, tls_keylog_index.last_line_hash, sizeof(hash)) == 0;
+}
+
+/*
+ * Check whether the index can be used for the newly opened keylog file,
+ * i.e. it is the same file, and it has not been truncated or rewritten;
+ * if not, start a new index for it.
+ */
+static bool
+tls_keylog_index_check(const char *tls_keylog_filename, FILE *keylog_file)
+{
+    ws_statb64 statb;
+    bool have_statb = ws_fstat64(ws_fileno(keylog_file), &statb) == 0;
+
+    if (have_statb && tls_keylog_index.records &&
+        g_strcmp0(tls_keylog_index.filename, tls_keylog_filename) == 0 &&
+        statb.st_dev == tls_keylog_index.statb.st_dev &&
+        statb.st_ino == tls_keylog_index.statb.st_ino &&
+        statb.st_size >= tls_keylog_index.offset &&
+        tls_keylog_index_check_last_line(keylog_file)) {
+        return true;
+    }
+
+    /* Without the file's identity, the index can't be reused later. */
+    g_free(tls_keylog_index.filename);
+    tls_keylog_index.filename = have_statb ? g_strdup(tls_keylog_filename) : NULL;
+    if (have_statb) {
+        tls_keylog_index.statb = statb;
+    }
+    tls_keylog_index.offset = 0;
+    tls_keylog_index.last_line_offset = 0;
+    if (tls_keylog_index.records) {
+        g_byte_array_set_size(tls_keylog_index.records, 0);
+    } else {
+        tls_keylog_index.records = g_byte_array_new();
+    }
+    return false;
+}
+
+static void
+tls_keylog_process_lines_internal(const ssl_master_key_map_t *mk_map, const uint8_t *data, unsigned datalen,
+                                  bool add_to_index)
 {
-    ssl_master_key_match_group_t mk_groups[] = {
-        { "encrypted_pmk",  mk_map->pre_master },
-        { "session_id",     mk_map->session },
-        { "client_random",  mk_map->crandom },
-        { "client_random_pms",  mk_map->pms },
-        /* TLS 1.3 map from Client Random to derived secret. */
-        { "client_early",       mk_map->tls13_client_early },
-        { "client_handshake",   mk_map->tls13_client_handshake },
-        { "server_handshake",   mk_map->tls13_server_handshake },
-        { "client_appdata",     mk_map->tls13_client_appdata },
-        { "server_appdata",     mk_map->tls13_server_appdata },
-        { "early_exporter",     mk_map->tls13_early_exporter },
-        { "exporter",           mk_map->tls13_exporter },
-    };
 
     /* The format of the file is a series of records with one of the following formats:
      *   - "RSA xxxx yyyy"
@@ -6808,6 +6936,7 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
             StringInfo *key = wmem_new(wmem_file_scope(), StringInfo);
             StringInfo *pre_ms_or_ms = NULL;
             GHashTable *ht = NULL;
+            unsigned group;
 
             /* Is the PMS being supplied with the PMS_CLIENT_RANDOM
              * otherwise we will use the Master Secret
@@ -6830,12 +6959,12 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
             g_free(hex_pre_ms_or_ms);
 
             /* Find a master key from any format (CLIENT_RANDOM, SID, ...) */
-            for (unsigned i = 0; i < G_N_ELEMENTS(mk_groups); i++) {
-                ssl_master_key_match_group_t *g = &mk_groups[i];
+            for (group = 0; group < G_N_ELEMENTS(mk_groups); group++) {
+                const ssl_master_key_match_group_t *g = &mk_groups[group];
                 hex_key = g_match_info_fetch_named(mi, g->re_group_name);
                 if (hex_key && *hex_key) {
                     ssl_debug_printf("    matched %s\n", g->re_group_name);
-                    ht = g->master_key_ht;
+                    ht = ssl_master_key_match_group_ht(mk_map, group);
                     from_hex(key, hex_key, strlen(hex_key));
                     g_free(hex_key);
                     break;
@@ -6845,6 +6974,9 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
             DISSECTOR_ASSERT(ht); /* Cannot be reached, or regex is wrong. */
 
             g_hash_table_insert(ht, key, pre_ms_or_ms);
+            if (add_to_index) {
+                tls_keylog_index_record(group, key, pre_ms_or_ms);
+            }
 
         } else if (linelen > 0 && line[0] != '#') {
             ssl_debug_printf("    unrecognized line\n");
@@ -6854,6 +6986,12 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
     }
 }
 
+void
+tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data, unsigned datalen)
+{
+    tls_keylog_process_lines_internal(mk_map, data, datalen, false);
+}
+
 void
 ssl_load_keyfile(const char *tls_keylog_filename, FILE **keylog_file,
                  const ssl_master_key_map_t *mk_map)
@@ -6885,10 +7023,23 @@ ssl_load_keyfile(const char *tls_keylog_filename, FILE **keylog_file,
             ssl_debug_printf("%s failed to open SSL keylog\n", G_STRFUNC);
             return;
         }
+
+        /* If this file was read before, take the secrets from the index
+         * and only read what was appended since. */
+        if (tls_keylog_index_check(tls_keylog_filename, *keylog_file) &&
+            ws_fseek64(*keylog_file, tls_keylog_index.offset, SEEK_SET) == 0) {
+            ssl_debug_printf("%s using index of the first %" PRId64 " bytes\n", G_STRFUNC,
+                             tls_keylog_index.offset);
+            tls_keylog_index_replay(mk_map);
+        } else {
+            rewind(*keylog_file);
+        }
     }
 
     for (;;) {
         char buf[1110], *line;
+        int64_t line_offset = ws_ftell64(*keylog_file);
+        size_t line_len;
         line = fgets(buf, sizeof(buf), *keylog_file);
         if (!line) {
             if (feof(*keylog_file)) {
@@ -6901,7 +7052,23 @@ ssl_load_keyfile(const char *tls_keylog_filename, FILE **keylog_file,
             }
             break;
         }
-        tls_keylog_process_lines(mk_map, (uint8_t *)line, (int)strlen(line));
+        line_len = strlen(line);
+        if (line_len > 0 && line[line_len - 1] != '\n' && feof(*keylog_file)) {
+            /* The last line may still be being written. Use what's there,
+             * but read it again next time, in case it was incomplete. */
+            tls_keylog_process_lines(mk_map, (uint8_t *)line, (unsigned)line_len);
+            clearerr(*keylog_file);
+            ws_fseek64(*keylog_file, line_offset, SEEK_SET);
+            break;
+        }
+        /* Only index lines that directly follow the indexed part of the file. */
+        bool add_to_index = line_offset == tls_keylog_index.offset;
+        tls_keylog_process_lines_internal(mk_map, (uint8_t *)line, (unsigned)line_len, add_to_index);
+        if (add_to_index) {
+            tls_keylog_index.offset = ws_ftell64(*keylog_file);
+            tls_keylog_index.last_line_offset = line_offset;
+            gcry_md_hash_buffer(GCRY_MD_SHA256, tls_keylog_index.last_line_hash, line, line_len);
+        }
     }
 }
 /** SSL keylog file handling. }}} */
@@ -24,6 +24,7 @@
 #include <epan/exceptions.h>
 #include <epan/show_exception.h>
 #include <epan/proto_data.h>
+#include <epan/stream_frame_index.h>
 
 #include <wsutil/utf8_entities.h>
 #include <wsutil/pint.h>
@@ -109,6 +110,7 @@ static bool udplite_check_checksum;
 static dissector_table_t udp_dissector_table;
 static heur_dissector_list_t heur_subdissector_list;
 static uint32_t udp_stream_count;
+static stream_frame_index_t *udp_stream_frames;
 
 /* Determine if there is a sub-dissector and call it.  This has been */
 /* separated into a stand alone routine so other protocol dissectors */
@@ -1227,6 +1229,9 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, uint32_t ip_proto)
     if (udpd) {
         item = proto_tree_add_uint(udp_tree, hf_udp_stream, tvb, offset, 0, udpd->stream);
         proto_item_set_generated(item);
+        if (!PINFO_FD_VISITED(pinfo)) {
+            stream_frame_index_add(udp_stream_frames, udpd->stream, pinfo->num);
+        }
 
         /* Copy the stream index into the header as well to make it available
         * to tap listeners.
@@ -1522,6 +1527,7 @@ proto_register_udp(void)
     register_decode_as(&udp_da);
     register_conversation_table(proto_udp, false, udpip_conversation_packet, udpip_endpoint_packet);
     register_conversation_filter("udp", "UDP", udp_filter_valid, udp_build_filter_by_id, NULL);
+    udp_stream_frames = stream_frame_index_register("udp.stream");
     register_follow_stream(proto_udp, "udp_follow", udp_follow_conv_filter, udp_follow_index_filter, udp_follow_address_filter,
                         udp_port_to_display, follow_tvb_tap_listener, get_udp_stream_count, NULL);
 
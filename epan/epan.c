@@ -601,7 +601,9 @@ epan_dissect_reset(epan_dissect_t *edt)
 	free_data_sources(&edt->pi);
 
 	if (edt->tvb) {
-		/* Free all tvb's chained from this tvb */
+		/* Free all tvb's chained from this tvb. Byte fields in the
+		 * tree may still refer to the data sources; freeing the tree
+		 * below doesn't read them. */
 		tvb_free_chain(edt->tvb);
 		edt->tvb = NULL;
 	}
@@ -711,7 +713,9 @@ epan_dissect_cleanup(epan_dissect_t* edt)
 	free_data_sources(&edt->pi);
 
 	if (edt->tvb) {
-		/* Free all tvb's chained from this tvb */
+		/* Free all tvb's chained from this tvb. Byte fields in the
+		 * tree may still refer to the data sources; freeing the tree
+		 * below doesn't read them. */
 		tvb_free_chain(edt->tvb);
 	}
 
@@ -22,15 +22,54 @@
 static void
 bytes_fvalue_new(fvalue_t *fv)
 {
-	fv->value.bytes = NULL;
+	fv->value.bytes_tvb.bytes = NULL;
+	fv->value.bytes_tvb.tvb = NULL;
+}
+
+/* Is the value still only in a tvbuff? */
+static inline bool
+bytes_in_tvb(const fvalue_t *fv)
+{
+	return fv->value.bytes == NULL && fv->value.bytes_tvb.tvb != NULL;
+}
+
+/* Get the data without copying it out of the tvbuff. */
+static const uint8_t *
+bytes_data(const fvalue_t *fv, size_t *size)
+{
+	if (bytes_in_tvb(fv)) {
+		*size = fv->value.bytes_tvb.length;
+		return tvb_get_ptr(fv->value.bytes_tvb.tvb, fv->value.bytes_tvb.offset, fv->value.bytes_tvb.length);
+	}
+	return (const uint8_t *)g_bytes_get_data(fv->value.bytes, size);
+}
+
+/* Copy the data out of the tvbuff if that hasn't been done yet. This
+ * doesn't change the value, so it's allowed on a const fvalue. */
+static GBytes *
+bytes_value(const fvalue_t *fv)
+{
+	if (bytes_in_tvb(fv)) {
+		fvalue_t *mutable_fv = (fvalue_t *)fv;
+		size_t size;
+		const uint8_t *data = bytes_data(fv, &size);
+
+		mutable_fv->value.bytes = g_bytes_new(data, size);
+		mutable_fv->value.bytes_tvb.tvb = NULL;
+	}
+	return fv->value.bytes;
 }
 
 static void
 bytes_fvalue_copy(fvalue_t *dst, const fvalue_t *src)
 {
-	dst->value.bytes = g_bytes_ref(src->value.bytes);
+	dst->value.bytes_tvb.tvb = NULL;
+	dst->value.bytes = g_bytes_ref(bytes_value(src));
 }
 
+/* The tvbuff of a value that was never copied out of it may already have
+ * been freed by the time the tree is (see proto_tree_set_bytes_tvb()), so
+ * this must not look at it. */
 static void
 bytes_fvalue_free(fvalue_t *fv)
 {
@@ -38,6 +77,7 @@ bytes_fvalue_free(fvalue_t *fv)
 		g_bytes_unref(fv->value.bytes);
 		fv->value.bytes = NULL;
 	}
+	fv->value.bytes_tvb.tvb = NULL;
 }
 
 
@@ -50,28 +90,54 @@ bytes_fvalue_set(fvalue_t *fv, GBytes *value)
 	fv->value.bytes = g_bytes_ref(value);
 }
 
+void
+bytes_fvalue_set_tvb(fvalue_t *fv, tvbuff_t *tvb, int offset, int length)
+{
+	/* Free up the old value, if we have one */
+	bytes_fvalue_free(fv);
+
+	fv->value.bytes_tvb.tvb = tvb;
+	fv->value.bytes_tvb.offset = offset;
+	fv->value.bytes_tvb.length = length;
+}
+
+const void *
+bytes_fvalue_get_data(const fvalue_t *fv, size_t *size)
+{
+	return bytes_data(fv, size);
+}
+
 static GBytes *
 bytes_fvalue_get(fvalue_t *fv)
 {
-	return g_bytes_ref(fv->value.bytes);
+	return g_bytes_ref(bytes_value(fv));
 }
 
 static char *
 oid_to_repr(wmem_allocator_t *scope, const fvalue_t *fv, ftrepr_t rtype _U_, int field_display _U_)
 {
-	return oid_encoded2string(scope, g_bytes_get_data(fv->value.bytes, NULL), (unsigned)g_bytes_get_size(fv->value.bytes));
+	size_t size;
+	const uint8_t *data = bytes_data(fv, &size);
+
+	return oid_encoded2string(scope, data, (unsigned)size);
 }
 
 static char *
 rel_oid_to_repr(wmem_allocator_t *scope, const fvalue_t *fv, ftrepr_t rtype _U_, int field_display _U_)
 {
-	return rel_oid_encoded2string(scope,  g_bytes_get_data(fv->value.bytes, NULL), (unsigned)g_bytes_get_size(fv->value.bytes));
+	size_t size;
+	const uint8_t *data = bytes_data(fv, &size);
+
+	return rel_oid_encoded2string(scope, data, (unsigned)size);
 }
 
 static char *
 system_id_to_repr(wmem_allocator_t *scope, const fvalue_t *fv, ftrepr_t rtype _U_, int field_display _U_)
 {
-	return print_system_id(scope,  g_bytes_get_data(fv->value.bytes, NULL), (unsigned)g_bytes_get_size(fv->value.bytes));
+	size_t size;
+	const uint8_t *data = bytes_data(fv, &size);
+
+	return print_system_id(scope, data, (unsigned)size);
 }
 
 char *
@@ -100,7 +166,7 @@ bytes_to_repr(wmem_allocator_t *scope, const fvalue_t *fv, ftrepr_t rtype, int f
 	const uint8_t *bytes;
 	size_t bytes_size;
 
-	bytes = g_bytes_get_data(fv->value.bytes, &bytes_size);
+	bytes = bytes_data(fv, &bytes_size);
 
 	if (rtype == FTREPR_DFILTER) {
 		if (bytes_size == 0) {
@@ -458,20 +524,33 @@ fcwwn_from_literal(fvalue_t *fv, const char *s, bool allow_partial_value _U_, ch
 static unsigned
 len(fvalue_t *fv)
 {
-	return (unsigned)g_bytes_get_size(fv->value.bytes);
+	size_t size;
+
+	bytes_data(fv, &size);
+	return (unsigned)size;
 }
 
 static void
 slice(fvalue_t *fv, GByteArray *bytes, unsigned offset, unsigned length)
 {
-	const uint8_t *data = (const uint8_t *)g_bytes_get_data(fv->value.bytes, NULL) + offset;
+	size_t size;
+	const uint8_t *data = bytes_data(fv, &size) + offset;
 	g_byte_array_append(bytes, data, length);
 }
 
+/* Same ordering as g_bytes_compare(). */
 static enum ft_result
 cmp_order(const fvalue_t *fv_a, const fvalue_t *fv_b, int *cmp)
 {
-	*cmp = g_bytes_compare(fv_a->value.bytes, fv_b->value.bytes);
+	const uint8_t *p_a, *p_b;
+	size_t size_a, size_b;
+
+	p_a = bytes_data(fv_a, &size_a);
+	p_b = bytes_data(fv_b, &size_b);
+
+	*cmp = MIN(size_a, size_b) ? memcmp(p_a, p_b, MIN(size_a, size_b)) : 0;
+	if (*cmp == 0 && size_a != size_b)
+		*cmp = size_a < size_b ? -1 : 1;
 	return FT_OK;
 }
 
@@ -482,8 +561,8 @@ bytes_bitwise_and(fvalue_t *fv_dst, const fvalue_t *fv_a, const fvalue_t *fv_b,
 	const uint8_t *p_a, *p_b;
 	size_t size_a, size_b;
 
-	p_a = g_bytes_get_data(fv_a->value.bytes, &size_a);
-	p_b = g_bytes_get_data(fv_b->value.bytes, &size_b);
+	p_a = bytes_data(fv_a, &size_a);
+	p_b = bytes_data(fv_b, &size_b);
 
 	size_t len = MIN(size_a, size_b);
 	if (len == 0) {
@@ -506,8 +585,8 @@ cmp_contains(const fvalue_t *fv_a, const fvalue_t *fv_b, bool *contains)
 	const void *data_a, *data_b;
 	size_t size_a, size_b;
 
-	data_a = g_bytes_get_data(fv_a->value.bytes, &size_a);
-	data_b = g_bytes_get_data(fv_b->value.bytes, &size_b);
+	data_a = bytes_data(fv_a, &size_a);
+	data_b = bytes_data(fv_b, &size_b);
 
 	if (ws_memmem(data_a, size_a, data_b, size_b)) {
 		*contains = true;
@@ -525,7 +604,7 @@ cmp_matches(const fvalue_t *fv, const ws_regex_t *regex, bool *matches)
 	const void *data;
 	size_t data_size;
 
-	data = g_bytes_get_data(fv->value.bytes, &data_size);
+	data = bytes_data(fv, &data_size);
 
 	*matches = ws_regex_matches_length(regex, data, data_size);
 	return FT_OK;
@@ -534,7 +613,7 @@ cmp_matches(const fvalue_t *fv, const ws_regex_t *regex, bool *matches)
 static unsigned
 bytes_hash(const fvalue_t *fv)
 {
-	return g_bytes_hash(fv->value.bytes);
+	return g_bytes_hash(bytes_value(fv));
 }
 
 static bool
@@ -543,7 +622,7 @@ bytes_is_zero(const fvalue_t *fv)
 	const uint8_t *data;
 	size_t data_size;
 
-	data = g_bytes_get_data(fv->value.bytes, &data_size);
+	data = bytes_data(fv, &data_size);
 
 	if (data_size == 0)
 		return true;
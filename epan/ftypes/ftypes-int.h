@@ -23,6 +23,15 @@ struct _fvalue_t {
 		double			floating;
 		wmem_strbuf_t		*strbuf;
 		GBytes			*bytes;
+		/* Bytes not yet copied out of a tvbuff; bytes_tvb.bytes
+		 * is the same as bytes and is NULL until the value is
+		 * copied. */
+		struct {
+			GBytes		*bytes;
+			tvbuff_t	*tvb;
+			int		offset;
+			int		length;
+		} bytes_tvb;
 		ipv4_addr_and_mask	ipv4;
 		ipv6_addr_and_prefix	ipv6;
 		e_guid_t		guid;
@@ -200,6 +209,12 @@ char *
 bytes_to_dfilter_repr(wmem_allocator_t *scope,
 			const uint8_t *src, size_t src_size);
 
+void
+bytes_fvalue_set_tvb(fvalue_t *fv, tvbuff_t *tvb, int offset, int length);
+
+const void *
+bytes_fvalue_get_data(const fvalue_t *fv, size_t *size);
+
 #endif /* FTYPES_INT_H */
 
 /*
@@ -472,6 +472,18 @@ fvalue_new(ftenum_t ftype)
 	return fv;
 }
 
+/* Allocate and initialize an fvalue_t from a wmem scope */
+fvalue_t*
+fvalue_new_wmem(wmem_allocator_t *scope, ftenum_t ftype)
+{
+	fvalue_t		*fv;
+
+	fv = wmem_new(scope, fvalue_t);
+	fvalue_init(fv, ftype);
+
+	return fv;
+}
+
 fvalue_t*
 fvalue_dup(const fvalue_t *fv_orig)
 {
@@ -926,6 +938,14 @@ fvalue_set_bytes_data(fvalue_t *fv, const void *data, size_t size)
 	g_bytes_unref(bytes);
 }
 
+void
+fvalue_set_bytes_tvb(fvalue_t *fv, tvbuff_t *tvb, int offset, int length)
+{
+	ws_assert(fv->ftype->ftype == FT_BYTES ||
+			fv->ftype->ftype == FT_UINT_BYTES);
+	bytes_fvalue_set_tvb(fv, tvb, offset, length);
+}
+
 void
 fvalue_set_fcwwn(fvalue_t *fv, const uint8_t *value)
 {
@@ -1106,6 +1126,13 @@ fvalue_get_bytes(fvalue_t *fv)
 size_t
 fvalue_get_bytes_size(fvalue_t *fv)
 {
+	if (fv->ftype->ftype == FT_BYTES || fv->ftype->ftype == FT_UINT_BYTES) {
+		/* Don't copy the value out of its tvbuff just to look at it. */
+		size_t size;
+		bytes_fvalue_get_data(fv, &size);
+		return size;
+	}
+
 	GBytes *bytes = fvalue_get_bytes(fv);
 	size_t size = g_bytes_get_size(bytes);
 	g_bytes_unref(bytes);
@@ -1115,6 +1142,11 @@ fvalue_get_bytes_size(fvalue_t *fv)
 const void *
 fvalue_get_bytes_data(fvalue_t *fv)
 {
+	if (fv->ftype->ftype == FT_BYTES || fv->ftype->ftype == FT_UINT_BYTES) {
+		size_t size;
+		return bytes_fvalue_get_data(fv, &size);
+	}
+
 	GBytes *bytes = fvalue_get_bytes(fv);
 	const void *data = g_bytes_get_data(bytes, NULL);
 	g_bytes_unref(bytes);
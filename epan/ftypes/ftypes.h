@@ -307,6 +307,13 @@ WS_DLL_PUBLIC
 fvalue_t*
 fvalue_new(ftenum_t ftype);
 
+/* Like fvalue_new(), but the fvalue_t is allocated from scope. Release
+ * it with fvalue_cleanup(), not fvalue_free(); the memory itself goes
+ * away with the scope. */
+WS_DLL_PUBLIC
+fvalue_t*
+fvalue_new_wmem(wmem_allocator_t *scope, ftenum_t ftype);
+
 WS_DLL_PUBLIC
 fvalue_t*
 fvalue_dup(const fvalue_t *fv);
@@ -392,6 +399,14 @@ WS_DLL_PUBLIC
 void
 fvalue_set_bytes_data(fvalue_t *fv, const void *data, size_t size);
 
+/* Set an FT_BYTES or FT_UINT_BYTES value that is copied out of the tvbuff
+ * only when something asks for it as a GBytes. The tvbuff must not be
+ * freed while the fvalue is in use; copies made with fvalue_dup() don't
+ * depend on it. */
+WS_DLL_PUBLIC
+void
+fvalue_set_bytes_tvb(fvalue_t *fv, tvbuff_t *tvb, int offset, int length);
+
 WS_DLL_PUBLIC
 void
 fvalue_set_fcwwn(fvalue_t *fv, const uint8_t *value);
@@ -13,6 +13,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/tvbuff.h>
@@ -95,22 +97,41 @@ in_cksum_ret_partial(const vec_t *vec, int veclen, uint16_t *partial)
 			byte_swapped = 1;
 		}
 		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * Sum the bulk of the chunk as 32-bit words into a 64-bit
+		 * accumulator; the upper halves collect the carries, so
+		 * there's no need to reduce until the end, and the compiler
+		 * can vectorize the loop. Folding the result to 16 bits
+		 * gives the same one's complement sum as adding up the
+		 * 16-bit words (RFC 1071, "Parallel Summation").
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
-		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
+		if (mlen >= 8) {
+			const uint8_t *p = (const uint8_t *)w;
+			uint64_t wsum = 0;
+			uint32_t dw[8];
+			int i;
+
+			while ((mlen -= 32) >= 0) {
+				memcpy(dw, p, 32);
+				for (i = 0; i < 8; i++)
+					wsum += dw[i];
+				p += 32;
+			}
+			mlen += 32;
+			while ((mlen -= 8) >= 0) {
+				memcpy(dw, p, 8);
+				wsum += dw[0];
+				wsum += dw[1];
+				p += 8;
+			}
+			mlen += 8;
+			w = (const uint16_t *)(const void *)p;
+
+			wsum = (wsum & 0xffffffff) + (wsum >> 32);
+			wsum = (wsum & 0xffffffff) + (wsum >> 32);
+			wsum = (wsum & 0xffff) + (wsum >> 16);
+			REDUCE;
+			sum += (int)wsum;
 		}
-		mlen += 8;
 		if (mlen == 0 && byte_swapped == 0)
 			continue;
 		REDUCE;
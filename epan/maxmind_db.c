@@ -160,12 +160,16 @@ static bool mmdbr_pipe_valid(void) {
     return pipe_valid;
 }
 
+// Upper bound on the number of bytes of queued requests sent in one write.
+#define MMDBR_MAX_WRITE_LEN 4096
+
 // Writing to mmdbr_pipe.stdin_fd can block. Do so in a separate thread.
 static void *
 write_mmdbr_stdin_worker(void *data _U_) {
     GIOStatus status;
     GError *err = NULL;
     size_t bytes_written;
+    GString *requests = g_string_sized_new(MMDBR_MAX_WRITE_LEN);
     ws_debug("starting write worker");
 
     while (1) {
@@ -179,25 +183,47 @@ write_mmdbr_stdin_worker(void *data _U_) {
         if (!request) {
             continue;
         }
-        if (strcmp(request, mmdbr_stop_sentinel) == 0) {
+
+        // Requests tend to arrive in bursts (e.g. when a GeoIP column is
+        // filled in for a screenful of packets). stdin_io is unbuffered,
+        // so send everything that's queued up in one write instead of
+        // one write per address.
+        bool stop = false;
+        g_string_truncate(requests, 0);
+        while (request) {
+            if (strcmp(request, mmdbr_stop_sentinel) == 0) {
+                stop = true;
+                g_free(request);
+                break;
+            }
+            g_string_append(requests, request);
             g_free(request);
-            return NULL;
+            if (requests->len >= MMDBR_MAX_WRITE_LEN) {
+                break;
+            }
+            request = (char *) g_async_queue_try_pop(mmdbr_request_q);
         }
 
-        ws_noisy("write %s ql %d", request, g_async_queue_length(mmdbr_request_q));
-        status = g_io_channel_write_chars(mmdbr_pipe.stdin_io, request, strlen(request), &bytes_written, &err);
-        if (status != G_IO_STATUS_NORMAL) {
-            ws_debug("write error %s. exiting thread.", err->message);
+        if (requests->len > 0) {
+            ws_noisy("write %zu bytes ql %d", requests->len, g_async_queue_length(mmdbr_request_q));
+            status = g_io_channel_write_chars(mmdbr_pipe.stdin_io, requests->str, requests->len, &bytes_written, &err);
+            if (status != G_IO_STATUS_NORMAL) {
+                ws_debug("write error %s. exiting thread.", err->message);
+                g_clear_error(&err);
+                g_string_free(requests, TRUE);
+                mmdb_response_t *response = g_new0(mmdb_response_t, 1);
+                response->fatal_err = true;
+                g_async_queue_push(mmdbr_response_q, response); // Will be freed by maxmind_db_pop_response.
+                return NULL;
+            }
             g_clear_error(&err);
-            g_free(request);
-            mmdb_response_t *response = g_new0(mmdb_response_t, 1);
-            response->fatal_err = true;
-            g_async_queue_push(mmdbr_response_q, response); // Will be freed by maxmind_db_pop_response.
-            return NULL;
         }
-        g_clear_error(&err);
-        g_free(request);
+
+        if (stop) {
+            break;
+        }
     }
+    g_string_free(requests, TRUE);
     return NULL;
 }
 
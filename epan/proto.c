@@ -302,7 +302,7 @@ proto_tree_set_protocol_tvb(field_info *fi, tvbuff_t *tvb, const char* field_dat
 static void
 proto_tree_set_bytes(field_info *fi, const uint8_t* start_ptr, int length);
 static void
-proto_tree_set_bytes_tvb(field_info *fi, tvbuff_t *tvb, int offset, int length);
+proto_tree_set_bytes_tvb(proto_tree *tree, field_info *fi, tvbuff_t *tvb, int offset, int length);
 static void
 proto_tree_set_bytes_gbytearray(field_info *fi, const GByteArray *value);
 static void
@@ -424,10 +424,29 @@ static GPtrArray *deregistered_slice;
 /* indexed by prefix, contains initializers */
 static GHashTable* prefixes;
 
+/*
+ * A field_info and the proto_node that will hold it in the tree are
+ * allocated together, and the field's value is allocated from the same
+ * per-packet pool right after them, so that walking the tree (printing,
+ * JSON/EK output, collecting fields for filters) reads each item from
+ * one contiguous piece of memory rather than from three separate heap
+ * allocations. The pool is a block allocator that's reset rather than
+ * freed between packets, so its blocks are reused from packet to packet.
+ *
+ * A field_info that never gets added to the tree just goes away with
+ * the pool.
+ */
+typedef struct {
+	proto_node node;
+	field_info fi;
+} field_info_node_t;
+
+#define FIELD_INFO_NODE(fi) \
+	((proto_node *)((char *)(fi) - offsetof(field_info_node_t, fi)))
+
 /* Contains information about a field when a dissector calls
  * proto_tree_add_item.  */
-#define FIELD_INFO_NEW(pool, fi)  fi = wmem_new(pool, field_info)
-#define FIELD_INFO_FREE(pool, fi) wmem_free(pool, fi)
+#define FIELD_INFO_NEW(pool, fi)  fi = &wmem_new(pool, field_info_node_t)->fi
 
 /* Contains the space for proto_nodes. */
 #define PROTO_NODE_INIT(node)			\
@@ -435,9 +454,6 @@ static GHashTable* prefixes;
 	node->last_child = NULL;		\
 	node->next = NULL;
 
-#define PROTO_NODE_FREE(pool, node)			\
-	wmem_free(pool, node)
-
 /* String space for protocol and field items for the GUI */
 #define ITEM_LABEL_NEW(pool, il)			\
 	il = wmem_new(pool, item_label_t);
@@ -836,7 +852,8 @@ proto_tree_free_node(proto_node *node, void *data _U_)
 
 	proto_tree_children_foreach(node, proto_tree_free_node, NULL);
 
-	fvalue_free(finfo->value);
+	/* The fvalue_t itself is freed along with the packet pool. */
+	fvalue_cleanup(finfo->value);
 	finfo->value = NULL;
 }
 
@@ -2746,7 +2763,7 @@ static void
 free_fvalue_cb(void *data)
 {
 	fvalue_t *fv = (fvalue_t*)data;
-	fvalue_free(fv);
+	fvalue_cleanup(fv);
 }
 
 /* Add an item to a proto_tree, using the text label registered to that item;
@@ -2783,12 +2800,12 @@ proto_tree_new_item(field_info *new_fi, proto_tree *tree,
 			break;
 
 		case FT_BYTES:
-			proto_tree_set_bytes_tvb(new_fi, tvb, start, length);
+			proto_tree_set_bytes_tvb(tree, new_fi, tvb, start, length);
 			break;
 
 		case FT_UINT_BYTES:
 			n = get_uint_value(tree, tvb, start, length, encoding);
-			proto_tree_set_bytes_tvb(new_fi, tvb, start + length, n);
+			proto_tree_set_bytes_tvb(tree, new_fi, tvb, start + length, n);
 
 			/* Instead of calling proto_item_set_len(), since we don't yet
 			 * have a proto_item, we set the field_info's length ourselves. */
@@ -4562,7 +4579,7 @@ proto_tree_add_bytes_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
 	}
 	else {
 		/* n will be zero except when it's a FT_UINT_BYTES */
-		proto_tree_set_bytes_tvb(new_fi, tvb, start + n, length);
+		proto_tree_set_bytes_tvb(tree, new_fi, tvb, start + n, length);
 
 		/* XXX: If we have a non-NULL tree but NULL retval, we don't
 		 * use the byte array created above in this case.
@@ -4848,11 +4865,55 @@ proto_tree_set_bytes(field_info *fi, const uint8_t* start_ptr, int length)
 }
 
 
+/* Is ds_tvb one of the packet's data sources? Those are only freed
+ * after the protocol tree, unlike tvbuffs dissectors create and free
+ * themselves. */
+static bool
+is_packet_data_source(const packet_info *pinfo, const tvbuff_t *ds_tvb)
+{
+	GSList *src;
+
+	for (src = pinfo->data_src; src; src = src->next) {
+		if (get_data_source_tvb((const struct data_source *)src->data) == ds_tvb)
+			return true;
+	}
+	return false;
+}
+
 static void
-proto_tree_set_bytes_tvb(field_info *fi, tvbuff_t *tvb, int offset, int length)
+proto_tree_set_bytes_tvb(proto_tree *tree, field_info *fi, tvbuff_t *tvb, int offset, int length)
 {
+	const uint8_t *ptr;
+	tvbuff_t *ds_tvb;
+	int ds_offset;
+
 	tvb_ensure_bytes_exist(tvb, offset, length);
-	proto_tree_set_bytes(fi, tvb_get_ptr(tvb, offset, length), length);
+	ptr = tvb_get_ptr(tvb, offset, length);
+
+	/* Most byte fields (payloads, opaque data) are only displayed, and
+	 * then only partially, so don't copy them out of the packet unless
+	 * something asks for the whole value. Only do that if the bytes
+	 * really are the data source's, and not e.g. decompressed data in
+	 * a child tvbuff.
+	 *
+	 * The data sources are freed in epan_dissect_reset() and
+	 * epan_dissect_cleanup() *before* the tree, so the tvbuff doesn't
+	 * outlive the field. That's safe because nothing reads the tree
+	 * between the two, and freeing the value (bytes_fvalue_free())
+	 * doesn't look at the tvbuff. A value that has to outlive the
+	 * dissection must be copied with fvalue_dup(), which copies the
+	 * bytes out of the tvbuff. */
+	ds_tvb = tvb_get_ds_tvb(tvb);
+	if (tree && length > 0 && is_packet_data_source(PTREE_DATA(tree)->pinfo, ds_tvb)) {
+		ds_offset = tvb_raw_offset(tvb) + offset;
+		if (tvb_bytes_exist(ds_tvb, ds_offset, length) &&
+		    tvb_get_ptr(ds_tvb, ds_offset, length) == ptr) {
+			fvalue_set_bytes_tvb(fi->value, ds_tvb, ds_offset, length);
+			return;
+		}
+	}
+
+	proto_tree_set_bytes(fi, ptr, length);
 }
 
 static void
@@ -6380,7 +6441,7 @@ proto_tree_add_node(proto_tree *tree, field_info *fi)
 		for (tnode = tree; tnode != NULL; tnode = tnode->parent) {
 			depth++;
 			if (G_UNLIKELY(depth > prefs.gui_max_tree_depth)) {
-				fvalue_free(fi->value);
+				fvalue_cleanup(fi->value);
 				fi->value = NULL;
 				THROW_MESSAGE(DissectorError, wmem_strdup_printf(PNODE_POOL(tree),
 						     "Maximum tree depth %d exceeded for \"%s\" - \"%s\" (%s:%u) (Maximum depth can be increased in advanced preferences)",
@@ -6405,14 +6466,14 @@ proto_tree_add_node(proto_tree *tree, field_info *fi)
 		/* Since we are not adding fi to a node, its fvalue won't get
 		 * freed by proto_tree_free_node(), so free it now.
 		 */
-		fvalue_free(fi->value);
+		fvalue_cleanup(fi->value);
 		fi->value = NULL;
 		REPORT_DISSECTOR_BUG("\"%s\" - \"%s\" tfi->tree_type: %d invalid (%s:%u)",
 				     fi->hfinfo->name, fi->hfinfo->abbrev, tfi->tree_type, __FILE__, __LINE__);
 		/* XXX - is it safe to continue here? */
 	}
 
-	pnode = wmem_new(PNODE_POOL(tree), proto_node);
+	pnode = FIELD_INFO_NODE(fi);
 	PROTO_NODE_INIT(pnode);
 	pnode->parent = tnode;
 	PNODE_FINFO(pnode) = fi;
@@ -6764,7 +6825,7 @@ new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 			FI_SET_FLAG(fi, FI_HIDDEN);
 		}
 	}
-	fi->value = fvalue_new(fi->hfinfo->type);
+	fi->value = fvalue_new_wmem(PNODE_POOL(tree), fi->hfinfo->type);
 	fi->rep        = NULL;
 
 	/* add the data source tvbuff */
@@ -118,6 +118,7 @@ free_stat_node(stat_node *node)
         g_free(bucket);
     }
 
+    g_free(node->rng_children);
     g_free(node->rng);
     g_free(node->name);
     g_free(node);
@@ -222,6 +223,7 @@ stats_tree_reinit(void *p)
     }
 
     st->root.children = NULL;
+    st->root.last_child = NULL;
     st->root.counter = 0;
     switch (st->root.datatype)
     {
@@ -482,7 +484,6 @@ new_stat_node(stats_tree *st, const char *name, int parent_id, stat_node_datatyp
 {
 
     stat_node *node = g_new0(stat_node, 1);
-    stat_node *last_chld = NULL;
 
     node->datatype = datatype;
     switch (datatype)
@@ -527,17 +528,12 @@ new_stat_node(stats_tree *st, const char *name, int parent_id, stat_node_datatyp
 
     if (node->parent->children) {
         /* insert as last child */
-
-        for (last_chld = node->parent->children;
-             last_chld->next;
-             last_chld = last_chld->next ) ;
-
-        last_chld->next = node;
-
+        node->parent->last_child->next = node;
     } else {
         /* insert as first child */
         node->parent->children = node;
     }
+    node->parent->last_child = node;
 
     if(node->parent->hash) {
         g_hash_table_replace(node->parent->hash,node->name,node);
@@ -853,6 +849,70 @@ get_range(char *rngstr)
     return rng;
 }
 
+/*
+ * Range nodes usually have ranges in ascending order that don't overlap,
+ * such as packet length buckets. Keep their children in an array so that
+ * stats_tree_tick_range() can find the right one with a binary search.
+ */
+static void
+index_range_children(stat_node *rng_root)
+{
+    stat_node *child;
+    stat_node *prev = NULL;
+    unsigned i = 0;
+
+    for (child = rng_root->children; child; child = child->next) {
+        if (!child->rng || child->rng->floor > child->rng->ceil) {
+            return;
+        }
+        if (prev && prev->rng->ceil >= child->rng->floor) {
+            return;
+        }
+        prev = child;
+        i++;
+    }
+
+    rng_root->rng_children = g_new(stat_node *, i);
+    rng_root->num_rng_children = i;
+    i = 0;
+    for (child = rng_root->children; child; child = child->next) {
+        rng_root->rng_children[i++] = child;
+    }
+}
+
+/* Find the child of a range node whose range contains value, if any */
+static stat_node *
+find_range_child(const stat_node *rng_root, int value)
+{
+    stat_node *child;
+
+    if (rng_root->rng_children) {
+        unsigned lo = 0;
+        unsigned hi = rng_root->num_rng_children;
+
+        /* Find the last range starting at or below value */
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+            if (rng_root->rng_children[mid]->rng->floor <= value) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo > 0 && value <= rng_root->rng_children[lo - 1]->rng->ceil) {
+            return rng_root->rng_children[lo - 1];
+        }
+        return NULL;
+    }
+
+    for (child = rng_root->children; child; child = child->next) {
+        if (value >= child->rng->floor && value <= child->rng->ceil) {
+            return child;
+        }
+    }
+    return NULL;
+}
+
 
 extern int
 stats_tree_create_range_node(stats_tree *st, const char *name, int parent_id, ...)
@@ -868,6 +928,7 @@ stats_tree_create_range_node(stats_tree *st, const char *name, int parent_id, ..
         range_node->rng = get_range(curr_range);
     }
     va_end( list );
+    index_range_children(rng_root);
 
     return rng_root->id;
 }
@@ -890,6 +951,7 @@ stats_tree_create_range_node_string(stats_tree *st, const char *name,
     if (range_node->rng->floor == range_node->rng->ceil) {
         range_node->rng->ceil = INT_MAX;
     }
+    index_range_children(rng_root);
 
     return rng_root->id;
 }
@@ -923,6 +985,7 @@ stats_tree_range_node_with_pname(stats_tree *st, const char *name,
         range_node->rng = get_range(curr_range);
     }
     va_end( list );
+    index_range_children(rng_root);
 
     return rng_root->id;
 }
@@ -936,7 +999,6 @@ stats_tree_tick_range(stats_tree *st, const char *name, int parent_id,
     stat_node *node = NULL;
     stat_node *parent = NULL;
     stat_node *child = NULL;
-    int stat_floor, stat_ceil;
 
     if (parent_id >= 0 && parent_id < (int) st->parents->len) {
         parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
@@ -963,23 +1025,18 @@ stats_tree_tick_range(stats_tree *st, const char *name, int parent_id,
     }
     node->st_flags |= ST_FLG_AVERAGE;
 
-    for ( child = node->children; child; child = child->next) {
-        stat_floor =  child->rng->floor;
-        stat_ceil = child->rng->ceil;
-
-        if ( value_in_range >= stat_floor && value_in_range <= stat_ceil ) {
-            child->counter++;
-            child->total.int_total += value_in_range;
-            if (child->minvalue.int_min > value_in_range) {
-                child->minvalue.int_min = value_in_range;
-            }
-            if (child->maxvalue.int_max < value_in_range) {
-                child->maxvalue.int_max = value_in_range;
-            }
-            child->st_flags |= ST_FLG_AVERAGE;
-            update_burst_calc(child, 1);
-            return node->id;
+    child = find_range_child(node, value_in_range);
+    if (child) {
+        child->counter++;
+        child->total.int_total += value_in_range;
+        if (child->minvalue.int_min > value_in_range) {
+            child->minvalue.int_min = value_in_range;
+        }
+        if (child->maxvalue.int_max < value_in_range) {
+            child->maxvalue.int_max = value_in_range;
         }
+        child->st_flags |= ST_FLG_AVERAGE;
+        update_burst_calc(child, 1);
     }
 
     return node->id;
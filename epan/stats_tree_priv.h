@@ -90,11 +90,17 @@ struct _stat_node {
 	/** relatives */
 	stat_node		*parent;
 	stat_node		*children;
+	stat_node		*last_child;
 	stat_node		*next;
 
 	/** used to check if value is within range */
 	range_pair_t		*rng;
 
+	/** range children sorted by range, for a range node whose ranges are
+	 *  in ascending order and don't overlap; NULL otherwise */
+	stat_node		**rng_children;
+	unsigned		num_rng_children;
+
 	/** node presentation data */
 	st_node_pres		*pr;
 };
@@ -0,0 +1,208 @@
+/* stream_frame_index.c
+ * Per-stream lists of the frames in which a stream index field was seen
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/wmem_scopes.h>
+#include <wsutil/strtoi.h>
+
+#include "stream_frame_index.h"
+
+typedef struct {
+    /* Differences between successive frame numbers, starting from 0,
+     * each encoded as a little-endian base 128 varint. Most frames of a
+     * stream are close together, so this usually takes 1 or 2 bytes
+     * per frame. */
+    wmem_array_t *deltas;
+    uint32_t last_frame;
+} stream_frames_t;
+
+struct stream_frame_index {
+    const char *field_name;
+    wmem_map_t *streams;    /* stream index -> stream_frames_t */
+};
+
+static wmem_map_t *registered_indexes;
+
+stream_frame_index_t *
+stream_frame_index_register(const char *field_name)
+{
+    stream_frame_index_t *sfi;
+
+    if (registered_indexes == NULL)
+        registered_indexes = wmem_map_new(wmem_epan_scope(), g_str_hash, g_str_equal);
+
+    sfi = wmem_new(wmem_epan_scope(), stream_frame_index_t);
+    sfi->field_name = field_name;
+    sfi->streams = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_direct_hash, g_direct_equal);
+
+    wmem_map_insert(registered_indexes, field_name, sfi);
+
+    return sfi;
+}
+
+void
+stream_frame_index_add(stream_frame_index_t *sfi, uint32_t stream, uint32_t frame_num)
+{
+    stream_frames_t *frames;
+    uint8_t varint[5];
+    unsigned len = 0;
+    uint32_t delta;
+
+    frames = (stream_frames_t *)wmem_map_lookup(sfi->streams, GUINT_TO_POINTER(stream));
+    if (frames == NULL) {
+        frames = wmem_new(wmem_file_scope(), stream_frames_t);
+        frames->deltas = wmem_array_sized_new(wmem_file_scope(), 1, 16);
+        frames->last_frame = 0;
+        wmem_map_insert(sfi->streams, GUINT_TO_POINTER(stream), frames);
+    }
+
+    /* A frame can carry the same stream more than once (e.g. ICMP errors
+     * quoting a TCP header), and frames are only added on the first,
+     * sequential pass, so anything not past the last frame is already
+     * there. */
+    if (frame_num <= frames->last_frame)
+        return;
+
+    delta = frame_num - frames->last_frame;
+    frames->last_frame = frame_num;
+
+    do {
+        varint[len] = delta & 0x7f;
+        delta >>= 7;
+        if (delta)
+            varint[len] |= 0x80;
+        len++;
+    } while (delta);
+
+    wmem_array_append(frames->deltas, varint, len);
+}
+
+/* Parse "<field> eq <N>" or "<field> == <N>", allowing surrounding
+ * whitespace. Only plain decimal numbers are accepted: the display
+ * filter scanner reads integer literals with base 0, so e.g. "010" is 8
+ * and "0x10" is 16, and anything that could be read differently is left
+ * to the display filter. */
+static bool
+parse_stream_filter(const char *filter, char **field_name, uint32_t *stream)
+{
+    const char *p = filter;
+    const char *name_start, *name_end;
+    const char *endptr;
+
+    while (g_ascii_isspace(*p))
+        p++;
+
+    name_start = p;
+    while (g_ascii_isalnum(*p) || *p == '_' || *p == '.' || *p == '-')
+        p++;
+    name_end = p;
+    if (name_end == name_start)
+        return false;
+
+    while (g_ascii_isspace(*p))
+        p++;
+
+    if (p[0] == '=' && p[1] == '=') {
+        p += 2;
+    } else if (p[0] == 'e' && p[1] == 'q' && g_ascii_isspace(p[2])) {
+        p += 3;
+    } else {
+        return false;
+    }
+
+    while (g_ascii_isspace(*p))
+        p++;
+
+    if (!g_ascii_isdigit(*p) || (p[0] == '0' && g_ascii_isalnum(p[1])))
+        return false;
+    if (!ws_strtou32(p, &endptr, stream))
+        return false;
+    p = endptr;
+
+    while (g_ascii_isspace(*p))
+        p++;
+    if (*p != '\0')
+        return false;
+
+    *field_name = g_strndup(name_start, name_end - name_start);
+    return true;
+}
+
+bool
+stream_frame_index_filter_iter(const char *filter, stream_frame_iter_t *iter)
+{
+    stream_frame_index_t *sfi;
+    stream_frames_t *frames;
+    char *field_name;
+    uint32_t stream;
+
+    if (registered_indexes == NULL || filter == NULL)
+        return false;
+
+    if (!parse_stream_filter(filter, &field_name, &stream))
+        return false;
+
+    sfi = (stream_frame_index_t *)wmem_map_lookup(registered_indexes, field_name);
+    g_free(field_name);
+    if (sfi == NULL)
+        return false;
+
+    iter->frame_num = 0;
+    frames = (stream_frames_t *)wmem_map_lookup(sfi->streams, GUINT_TO_POINTER(stream));
+    if (frames == NULL) {
+        /* Stream not seen (yet). */
+        iter->cur = iter->end = NULL;
+    } else {
+        iter->cur = (const uint8_t *)wmem_array_get_raw(frames->deltas);
+        iter->end = iter->cur + wmem_array_get_count(frames->deltas);
+    }
+
+    return true;
+}
+
+bool
+stream_frame_iter_next(stream_frame_iter_t *iter, uint32_t *frame_num)
+{
+    uint32_t delta = 0;
+    unsigned shift = 0;
+
+    if (iter->cur >= iter->end)
+        return false;
+
+    while (iter->cur < iter->end) {
+        uint8_t byte = *iter->cur++;
+        delta |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            break;
+        shift += 7;
+    }
+
+    iter->frame_num += delta;
+    *frame_num = iter->frame_num;
+    return true;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentation=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,80 @@
+/** @file
+ *
+ * Per-stream lists of the frames in which a stream index field
+ * (e.g. "tcp.stream") was seen, so that filters of the form
+ * "tcp.stream eq N" can be applied without dissecting every frame.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __STREAM_FRAME_INDEX_H__
+#define __STREAM_FRAME_INDEX_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+typedef struct stream_frame_index stream_frame_index_t;
+
+/** Iterator over the frames of one stream, in increasing frame number order. */
+typedef struct {
+    const uint8_t *cur;
+    const uint8_t *end;
+    uint32_t frame_num;
+} stream_frame_iter_t;
+
+/**
+ * Register a stream frame index. Must be called when registering the
+ * protocol that owns the field.
+ *
+ * @param field_name The filter name of the stream index field, e.g. "tcp.stream".
+ * @return The index, to be passed to stream_frame_index_add().
+ */
+WS_DLL_PUBLIC stream_frame_index_t *stream_frame_index_register(const char *field_name);
+
+/**
+ * Record that a frame belongs to a stream. Only frames dissected on the
+ * first pass are recorded; the index is discarded along with the rest
+ * of the file-scope state.
+ *
+ * @param sfi The index returned by stream_frame_index_register().
+ * @param stream The stream index.
+ * @param frame_num The frame number.
+ */
+WS_DLL_PUBLIC void stream_frame_index_add(stream_frame_index_t *sfi, uint32_t stream, uint32_t frame_num);
+
+/**
+ * Check whether a display filter is a plain "<field> eq <N>" or
+ * "<field> == <N>" comparison against a field that has a stream frame
+ * index and, if so, start iterating over the frames of that stream.
+ *
+ * @param filter The display filter text.
+ * @param iter Set to iterate over the frames of the stream.
+ * @return true if the filter matches exactly the frames returned by
+ * iter, false if it must be applied by dissecting each frame.
+ */
+WS_DLL_PUBLIC bool stream_frame_index_filter_iter(const char *filter, stream_frame_iter_t *iter);
+
+/**
+ * Get the next frame of the stream.
+ *
+ * @param iter The iterator.
+ * @param frame_num Set to the next frame number.
+ * @return true if there was another frame, false at the end of the stream.
+ */
+WS_DLL_PUBLIC bool stream_frame_iter_next(stream_frame_iter_t *iter, uint32_t *frame_num);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __STREAM_FRAME_INDEX_H__ */
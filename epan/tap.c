@@ -86,6 +86,11 @@ typedef struct _tap_listener_t {
 	unsigned flags;
 	char *fstring;
 	dfilter_t *code;
+	/* The top-level "&&" terms of the filter, shared with other
+	 * listeners, or NULL if the filter can't be split. */
+	GPtrArray *clauses;
+	bool use_clauses;	/* apply the clauses instead of code */
+	int filter_result;	/* -1 if not applied yet to the current packet */
 	void *tapdata;
 	tap_reset_cb reset;
 	tap_packet_cb packet;
@@ -95,6 +100,310 @@ typedef struct _tap_listener_t {
 
 static tap_listener_t *tap_listener_queue;
 
+/* Several listeners often have filters in common: the graphs of an I/O
+ * graph combine their display filter with their Y field as
+ * "<filter> && (<field>)", so graphs with the same filter and different
+ * Y fields, or the same Y field and different filters, share a term;
+ * and many filters start by testing the same protocol. A filter that is
+ * a conjunction is split into its top-level "&&" terms ("clauses"), and
+ * listeners with a clause in common share it, so that each clause is
+ * applied at most once per packet.
+ */
+typedef struct _tap_filter_clause_t {
+	struct _tap_filter_clause_t *next;
+	char *fstring;
+	dfilter_t *code;
+	unsigned refcount;
+	bool used;	/* some listener applies its clauses */
+	int result;	/* -1 if not applied yet to the current packet */
+} tap_filter_clause_t;
+
+static tap_filter_clause_t *tap_filter_clause_list;
+
+/* Can c be part of a field name, keyword or bare value? */
+static inline bool
+is_filter_word_char(char c)
+{
+	return g_ascii_isalnum(c) || c == '_' || c == '.' || c == '-' || c == ':';
+}
+
+/* Does the word starting at p, which ends before end, equal keyword? */
+static bool
+is_filter_keyword(const char *p, const char *end, const char *keyword)
+{
+	size_t len = strlen(keyword);
+
+	return (size_t)(end - p) >= len &&
+		g_ascii_strncasecmp(p, keyword, len) == 0 &&
+		(p + len == end || !is_filter_word_char(p[len]));
+}
+
+/* Split the filter text between fstring and end into its top-level "&&"
+ * terms, removing brackets around the whole text or a term, and add them
+ * to terms. A filter with a top-level "||" or "^^" is added as a single
+ * term, since splitting it would change how it binds. Returns false if the
+ * filter contains something not handled here (macros, field references,
+ * layer operators, comments, unbalanced brackets or quotes), in which case
+ * it isn't split at all.
+ */
+static bool
+split_filter_clauses(const char *fstring, const char *end, GPtrArray *terms)
+{
+	const char *start = fstring;
+	const char *p;
+	const char *term;
+	int depth = 0;
+	char quote = '\0';
+	bool wrapped;
+	bool has_or = false;
+	GArray *splits;
+	unsigned i;
+	bool ok = true;
+
+	while (start < end && g_ascii_isspace(*start))
+		start++;
+	while (end > start && g_ascii_isspace(end[-1]))
+		end--;
+	if (start == end)
+		return false;
+
+	wrapped = *start == '(';
+	splits = g_array_new(false, false, sizeof(const char *));
+	for (p = start; p < end && ok; p++) {
+		if (quote) {
+			if (*p == '\\' && p + 1 < end)
+				p++;
+			else if (*p == quote)
+				quote = '\0';
+			continue;
+		}
+		switch (*p) {
+
+		case '"':
+		case '\'':
+			quote = *p;
+			continue;
+
+		case '(':
+		case '[':
+		case '{':
+			depth++;
+			continue;
+
+		case ')':
+		case ']':
+		case '}':
+			if (--depth < 0)
+				ok = false;
+			else if (depth == 0 && p + 1 < end)
+				wrapped = false;
+			continue;
+
+		case '$':
+		case '#':
+			ok = false;
+			continue;
+
+		case '/':
+			if (p + 1 < end && p[1] == '*')
+				ok = false;
+			continue;
+		}
+		if (depth > 0)
+			continue;
+
+		if ((p[0] == '&' || p[0] == '|' || p[0] == '^') && p + 1 < end && p[1] == p[0]) {
+			if (p[0] == '&')
+				g_array_append_val(splits, p);
+			else
+				has_or = true;
+			p++;
+		} else if (is_filter_word_char(*p) && (p == start || !is_filter_word_char(p[-1]))) {
+			if (is_filter_keyword(p, end, "and"))
+				g_array_append_val(splits, p);
+			else if (is_filter_keyword(p, end, "or") || is_filter_keyword(p, end, "xor"))
+				has_or = true;
+			while (p + 1 < end && is_filter_word_char(p[1]))
+				p++;
+		}
+	}
+	if (!ok || quote || depth != 0) {
+		g_array_free(splits, true);
+		return false;
+	}
+
+	if (wrapped) {
+		ok = split_filter_clauses(start + 1, end - 1, terms);
+	} else if (has_or || splits->len == 0) {
+		g_ptr_array_add(terms, g_strndup(start, end - start));
+	} else {
+		term = start;
+		for (i = 0; i < splits->len && ok; i++) {
+			p = g_array_index(splits, const char *, i);
+			ok = split_filter_clauses(term, p, terms);
+			/* Skip "&&" or "and" */
+			term = p + (*p == '&' ? 2 : 3);
+		}
+		if (ok)
+			ok = split_filter_clauses(term, end, terms);
+	}
+	g_array_free(splits, true);
+	return ok;
+}
+
+/* Get the shared clause for a term, compiling it if it's new */
+static tap_filter_clause_t *
+tap_filter_clause_get(const char *fstring)
+{
+	tap_filter_clause_t *clause;
+	dfilter_t *code;
+
+	for(clause=tap_filter_clause_list;clause;clause=clause->next){
+		if(strcmp(clause->fstring, fstring) == 0){
+			clause->refcount++;
+			return clause;
+		}
+	}
+	if(!dfilter_compile(fstring, &code, NULL)){
+		return NULL;
+	}
+	clause=g_new0(tap_filter_clause_t, 1);
+	clause->fstring=g_strdup(fstring);
+	clause->code=code;
+	clause->refcount=1;
+	clause->result=-1;
+	clause->next=tap_filter_clause_list;
+	tap_filter_clause_list=clause;
+	return clause;
+}
+
+static void
+tap_filter_clause_release(tap_filter_clause_t *clause)
+{
+	tap_filter_clause_t **prev;
+
+	if(--clause->refcount > 0){
+		return;
+	}
+	for(prev=&tap_filter_clause_list;*prev;prev=&(*prev)->next){
+		if(*prev==clause){
+			*prev=clause->next;
+			break;
+		}
+	}
+	dfilter_free(clause->code);
+	g_free(clause->fstring);
+	g_free(clause);
+}
+
+static void
+tap_listener_release_clauses(tap_listener_t *tl)
+{
+	unsigned i;
+
+	if(tl->clauses){
+		for(i=0;i<tl->clauses->len;i++){
+			tap_filter_clause_release((tap_filter_clause_t *)g_ptr_array_index(tl->clauses, i));
+		}
+		g_ptr_array_free(tl->clauses, true);
+		tl->clauses=NULL;
+	}
+	tl->use_clauses=false;
+}
+
+/* Split a listener's filter into shared clauses. If that isn't possible,
+ * the listener applies its own filter.
+ */
+static void
+tap_listener_set_clauses(tap_listener_t *tl)
+{
+	GPtrArray *terms;
+	tap_filter_clause_t *clause;
+	unsigned i;
+
+	tap_listener_release_clauses(tl);
+	if(!tl->code || !tl->fstring){
+		return;
+	}
+	terms=g_ptr_array_new_with_free_func(g_free);
+	if(split_filter_clauses(tl->fstring, tl->fstring + strlen(tl->fstring), terms)){
+		tl->clauses=g_ptr_array_sized_new(terms->len);
+		for(i=0;i<terms->len;i++){
+			clause=tap_filter_clause_get((const char *)g_ptr_array_index(terms, i));
+			if(!clause){
+				tap_listener_release_clauses(tl);
+				break;
+			}
+			g_ptr_array_add(tl->clauses, clause);
+		}
+	}
+	g_ptr_array_free(terms, true);
+}
+
+/* Applying the clauses separately costs more than applying the whole
+ * filter unless some of them are shared, so only listeners with a clause
+ * in common with another listener use them.
+ */
+static void
+update_shared_clauses(void)
+{
+	tap_filter_clause_t *clause;
+	tap_listener_t *tl;
+	unsigned i;
+
+	for(clause=tap_filter_clause_list;clause;clause=clause->next){
+		clause->used=false;
+	}
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		tl->use_clauses=false;
+		if(!tl->clauses){
+			continue;
+		}
+		for(i=0;i<tl->clauses->len;i++){
+			clause=(tap_filter_clause_t *)g_ptr_array_index(tl->clauses, i);
+			if(clause->refcount > 1){
+				tl->use_clauses=true;
+				break;
+			}
+		}
+		if(tl->use_clauses){
+			for(i=0;i<tl->clauses->len;i++){
+				clause=(tap_filter_clause_t *)g_ptr_array_index(tl->clauses, i);
+				clause->used=true;
+			}
+		}
+	}
+}
+
+/* Apply a listener's filter to the current packet, using the results of
+ * its clauses that other listeners have already applied.
+ */
+static bool
+tap_listener_filter_matches(tap_listener_t *tl, epan_dissect_t *edt)
+{
+	tap_filter_clause_t *clause;
+	unsigned i;
+
+	if(tl->filter_result < 0){
+		if(!tl->use_clauses){
+			tl->filter_result = dfilter_apply_edt(tl->code, edt) ? 1 : 0;
+		} else {
+			tl->filter_result = 1;
+			for(i=0;i<tl->clauses->len;i++){
+				clause=(tap_filter_clause_t *)g_ptr_array_index(tl->clauses, i);
+				if(clause->result < 0){
+					clause->result = dfilter_apply_edt(clause->code, edt) ? 1 : 0;
+				}
+				if(clause->result == 0){
+					tl->filter_result = 0;
+					break;
+				}
+			}
+		}
+	}
+	return tl->filter_result == 1;
+}
+
 static GSList *tap_plugins;
 
 #ifdef HAVE_PLUGINS
@@ -263,6 +572,7 @@ tap_queue_packet(int tap_id, packet_info *pinfo, const void *tap_specific_data)
 void tap_build_interesting (epan_dissect_t *edt)
 {
 	tap_listener_t *tl;
+	tap_filter_clause_t *clause;
 
 	/* nothing to do, just return */
 	if(!tap_listener_queue){
@@ -272,10 +582,15 @@ void tap_build_interesting (epan_dissect_t *edt)
 	/* loop over all tap listeners and build the list of all
 	   interesting hf_fields */
 	for(tl=tap_listener_queue;tl;tl=tl->next){
-		if(tl->code){
+		if(tl->code && !tl->use_clauses){
 			epan_dissect_prime_with_dfilter(edt, tl->code);
 		}
 	}
+	for(clause=tap_filter_clause_list;clause;clause=clause->next){
+		if(clause->used){
+			epan_dissect_prime_with_dfilter(edt, clause->code);
+		}
+	}
 }
 
 /* This function is used to delete/initialize the tap queue and prime an
@@ -305,6 +620,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 {
 	tap_packet_t *tp;
 	tap_listener_t *tl;
+	tap_filter_clause_t *clause;
 	unsigned i;
 
 	/* nothing to do, just return */
@@ -319,6 +635,14 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 		return;
 	}
 
+	/* Filter results are for this packet only. */
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		tl->filter_result=-1;
+	}
+	for(clause=tap_filter_clause_list;clause;clause=clause->next){
+		clause->result=-1;
+	}
+
 	/* loop over all tap listeners and call the listener callback
 	   for all packets that match the filter. */
 	for(i=0;i<tap_packet_index;i++){
@@ -350,7 +674,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 					 */
 					unsigned flags = tl->flags;
 					if(tl->code){
-						if (!dfilter_apply_edt(tl->code, edt)){
+						if (!tap_listener_filter_matches(tl, edt)){
 							/* The packet didn't
 							 * pass the filter. */
 							if (tl->flags & TL_IGNORE_DISPLAY_FILTER)
@@ -521,6 +845,7 @@ free_tap_listener(tap_listener_t *tl)
 	if (tl->finish) {
 		tl->finish(tl->tapdata);
 	}
+	tap_listener_release_clauses(tl);
 	dfilter_free(tl->code);
 	g_free(tl->fstring);
 	g_free(tl);
@@ -577,6 +902,8 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	tl->next=tap_listener_queue;
 
 	tap_listener_queue=tl;
+	tap_listener_set_clauses(tl);
+	update_shared_clauses();
 
 	return NULL;
 }
@@ -622,11 +949,15 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 						 "Filter \"%s\" is invalid - %s",
 						 fstring, df_err->msg);
 				df_error_free(&df_err);
+				tap_listener_set_clauses(tl);
+				update_shared_clauses();
 				return error_string;
 			}
 		}
 		tl->fstring=g_strdup(fstring);
 		tl->code=code;
+		tap_listener_set_clauses(tl);
+		update_shared_clauses();
 	}
 
 	return NULL;
@@ -639,7 +970,12 @@ tap_listeners_dfilter_recompile(void)
 {
 	tap_listener_t *tl;
 	dfilter_t *code;
+	bool valid;
 
+	/* Drop all the clauses first, so that none compiled before is reused */
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		tap_listener_release_clauses(tl);
+	}
 	for(tl=tap_listener_queue;tl;tl=tl->next){
 		if(tl->code){
 			dfilter_free(tl->code);
@@ -647,14 +983,20 @@ tap_listeners_dfilter_recompile(void)
 		}
 		tl->needs_redraw=true;
 		code=NULL;
+		valid=true;
 		if(tl->fstring){
 			if(!dfilter_compile(tl->fstring, &code, NULL)){
 				/* Not valid, make a dfilter matching no packets */
 				dfilter_compile("frame.number == 0", &code, NULL);
+				valid=false;
 			}
 		}
 		tl->code=code;
+		if(valid){
+			tap_listener_set_clauses(tl);
+		}
 	}
+	update_shared_clauses();
 }
 
 /* this function removes a tap listener
@@ -686,6 +1028,7 @@ remove_tap_listener(void *tapdata)
 		}
 	}
 	free_tap_listener(tl);
+	update_shared_clauses();
 }
 
 /*
@@ -708,6 +1051,31 @@ tap_listeners_require_dissection(void)
 
 }
 
+/*
+ * If all the tap listeners that require dissection have the same filter,
+ * return it, so that packets that don't match it needn't be dissected for
+ * the taps. Return NULL otherwise, or if no tap listener requires
+ * dissection.
+ */
+const char *
+tap_listeners_common_filter(void)
+{
+	tap_listener_t *tl;
+	const char *fstring = NULL;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->flags & TL_IS_DISSECTOR_HELPER)
+			continue;
+		if(!tl->fstring)
+			return NULL;
+		if(!fstring)
+			fstring=tl->fstring;
+		else if(strcmp(fstring, tl->fstring) != 0)
+			return NULL;
+	}
+	return fstring;
+}
+
 /*
  * Return true if we have one or more tap listeners that require the columns,
  * false otherwise.
@@ -259,6 +259,14 @@ WS_DLL_PUBLIC void remove_tap_listener(void *tapdata);
  */
 WS_DLL_PUBLIC bool tap_listeners_require_dissection(void);
 
+/**
+ * If all the tap listeners that require dissection have the same filter,
+ * return it; only the packets that match it need to be dissected for
+ * the taps. Return NULL otherwise, or if no tap listener requires
+ * dissection.
+ */
+WS_DLL_PUBLIC const char *tap_listeners_common_filter(void);
+
 /**
  * Return true if we have one or more tap listeners that require the columns,
  * false otherwise.
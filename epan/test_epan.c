@@ -9,6 +9,10 @@
 #include "config.h"
 
 #include "strutil.h"
+#include "stream_frame_index.h"
+#include "tvbuff.h"
+#include "in_cksum.h"
+#include "wmem_scopes.h"
 #include <wsutil/utf8_entities.h>
 
 /*
@@ -74,20 +78,134 @@ void test_label_escape_control(void)
     g_assert_cmpuint(pos, ==, strlen(dst));
 }
 
+static void test_stream_frame_index(void)
+{
+    stream_frame_index_t *sfi;
+    stream_frame_iter_t iter;
+    uint32_t frame_num;
+
+    wmem_enter_file_scope();
+
+    sfi = stream_frame_index_register("test.stream");
+    stream_frame_index_add(sfi, 8, 1);
+    stream_frame_index_add(sfi, 10, 2);
+    stream_frame_index_add(sfi, 8, 3);
+    stream_frame_index_add(sfi, 8, 3);
+    stream_frame_index_add(sfi, 8, 300);
+
+    g_assert_true(stream_frame_index_filter_iter("test.stream eq 8", &iter));
+    g_assert_true(stream_frame_iter_next(&iter, &frame_num));
+    g_assert_cmpuint(frame_num, ==, 1);
+    g_assert_true(stream_frame_iter_next(&iter, &frame_num));
+    g_assert_cmpuint(frame_num, ==, 3);
+    g_assert_true(stream_frame_iter_next(&iter, &frame_num));
+    g_assert_cmpuint(frame_num, ==, 300);
+    g_assert_false(stream_frame_iter_next(&iter, &frame_num));
+
+    g_assert_true(stream_frame_index_filter_iter(" test.stream == 10 ", &iter));
+    g_assert_true(stream_frame_iter_next(&iter, &frame_num));
+    g_assert_cmpuint(frame_num, ==, 2);
+    g_assert_false(stream_frame_iter_next(&iter, &frame_num));
+
+    /* A stream that hasn't been seen has no frames. */
+    g_assert_true(stream_frame_index_filter_iter("test.stream eq 0", &iter));
+    g_assert_false(stream_frame_iter_next(&iter, &frame_num));
+
+    /* The display filter reads these as octal and hex (stream 8 and 16),
+     * so they must be left to it. */
+    g_assert_false(stream_frame_index_filter_iter("test.stream eq 010", &iter));
+    g_assert_false(stream_frame_index_filter_iter("test.stream eq 0x10", &iter));
+    g_assert_false(stream_frame_index_filter_iter("test.stream eq 00", &iter));
+
+    /* Anything but a plain comparison isn't handled by the index. */
+    g_assert_false(stream_frame_index_filter_iter("test.stream eq 8 && frame", &iter));
+    g_assert_false(stream_frame_index_filter_iter("test.stream > 8", &iter));
+    g_assert_false(stream_frame_index_filter_iter("other.stream eq 8", &iter));
+
+    wmem_leave_file_scope();
+}
+
+/* The one's complement sum of the data, as 16-bit big-endian words, with
+ * chunks joined together, the way RFC 1071 defines it. Returned in network
+ * byte order, like in_cksum(). */
+static int in_cksum_reference(const vec_t *vec, int veclen)
+{
+    uint64_t sum = 0;
+    bool odd = false;
+    int i, j;
+
+    for (i = 0; i < veclen; i++) {
+        for (j = 0; j < vec[i].len; j++) {
+            sum += odd ? vec[i].ptr[j] : (uint64_t)vec[i].ptr[j] << 8;
+            odd = !odd;
+        }
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return g_htons(~sum & 0xffff);
+}
+
+static void test_in_cksum(void)
+{
+    static uint8_t buf[70000 + 8];
+    vec_t vec[4];
+    GRand *rand;
+    unsigned i;
+    int offset, len, veclen, pos, n, k;
+
+    rand = g_rand_new_with_seed(1071);
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)g_rand_int(rand);
+    }
+
+    /* Odd and even lengths and unaligned starts, in one chunk or split
+     * into up to four chunks at arbitrary points. */
+    for (offset = 0; offset < 8; offset++) {
+        for (len = 0; len <= 100; len++) {
+            for (veclen = 1; veclen <= 4; veclen++) {
+                pos = offset;
+                for (k = 0; k < veclen; k++) {
+                    n = k == veclen - 1 ? offset + len - pos : g_rand_int_range(rand, 0, offset + len - pos + 1);
+                    SET_CKSUM_VEC_PTR(vec[k], buf + pos, n);
+                    pos += n;
+                }
+                g_assert_cmphex(in_cksum(vec, veclen), ==, in_cksum_reference(vec, veclen));
+            }
+        }
+    }
+
+    /* More than 64 KiB in a chunk, all ones, so the 32-bit words add up
+     * to far more than a 32-bit sum can hold. */
+    memset(buf, 0xff, sizeof(buf));
+    SET_CKSUM_VEC_PTR(vec[0], buf + 1, 70001);
+    g_assert_cmphex(in_cksum(vec, 1), ==, in_cksum_reference(vec, 1));
+    SET_CKSUM_VEC_PTR(vec[0], buf, 3);
+    SET_CKSUM_VEC_PTR(vec[1], buf + 3, 70000);
+    g_assert_cmphex(in_cksum(vec, 2), ==, in_cksum_reference(vec, 2));
+
+    g_rand_free(rand);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
 
     ws_log_init("test_proto", NULL);
+    wmem_init_scopes();
 
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/label/strcat", test_label_strcat);
     g_test_add_func("/label/escape_whitespace", test_label_strcat_escape_whitespace);
     g_test_add_func("/label/escape_control", test_label_escape_control);
+    g_test_add_func("/stream_frame_index", test_stream_frame_index);
+    g_test_add_func("/in_cksum", test_in_cksum);
 
     ret = g_test_run();
 
+    wmem_cleanup_scopes();
+
     return ret;
 }
 
@@ -44,6 +44,7 @@
 #include <epan/addr_resolv.h>
 #include <epan/color_filters.h>
 #include <epan/secrets.h>
+#include <epan/stream_frame_index.h>
 
 #include "cfile.h"
 #include "file.h"
@@ -129,6 +130,8 @@ static match_result match_time_reference(capture_file *cf, frame_data *fdata,
         wtap_rec *, Buffer *, void *criterion);
 static bool find_packet(capture_file *cf, ws_match_function match_function,
         void *criterion, search_direction dir);
+static bool find_packet_data(capture_file *cf, ws_match_function match_function,
+        void *criterion, search_direction dir);
 
 static void cf_rename_failure_alert_box(const char *filename, int err);
 
@@ -1691,6 +1694,10 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
     bool        compiled _U_;
     uint32_t    frames_count;
     rescan_type queued_rescan_type = RESCAN_NONE;
+    bool        use_stream_frames;
+    stream_frame_iter_t stream_frames;
+    bool        have_stream_frame = false;
+    uint32_t    stream_frame_num = 0;
 
     if (cf->state == FILE_CLOSED || cf->state == FILE_READ_PENDING) {
         return;
@@ -1858,6 +1865,21 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
 
     epan_dissect_init(&edt, cf->epan, create_proto_tree, false);
 
+    /*
+     * If the filter is just "tcp.stream eq N" or similar, and nothing
+     * else needs to see every frame, only the frames recorded for that
+     * stream on the first pass can pass the filter; don't read or
+     * dissect any of the others. Tap listeners with the same filter,
+     * e.g. Follow Stream's, don't need to see the others either.
+     */
+    use_stream_frames = !redissect &&
+        (!tap_listeners_require_dissection() ||
+         g_strcmp0(tap_listeners_common_filter(), cf->dfilter) == 0) &&
+        stream_frame_index_filter_iter(cf->dfilter, &stream_frames);
+    if (use_stream_frames) {
+        have_stream_frame = stream_frame_iter_next(&stream_frames, &stream_frame_num);
+    }
+
     if (redissect) {
         /*
          * Decryption secrets and name resolution blocks are read while
@@ -1945,9 +1967,6 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
         /* Frame dependencies from the previous dissection/filtering are no longer valid. */
         fdata->dependent_of_displayed = 0;
 
-        if (!cf_read_record(cf, fdata, &rec, &buf))
-            break; /* error reading the frame */
-
         /* If the previous frame is displayed, and we haven't yet seen the
            selected frame, remember that frame - it's the closest one we've
            yet seen before the selected frame. */
@@ -1956,9 +1975,30 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
             preceding_frame = prev_frame;
         }
 
-        add_packet_to_packet_list(fdata, cf, &edt, cf->dfcode,
-                cinfo, &rec, &buf,
-                add_to_packet_list);
+        if (use_stream_frames) {
+            while (have_stream_frame && stream_frame_num < fdata->num) {
+                have_stream_frame = stream_frame_iter_next(&stream_frames, &stream_frame_num);
+            }
+        }
+
+        if (use_stream_frames && fdata->visited && !fdata->ref_time &&
+            (!have_stream_frame || stream_frame_num != fdata->num)) {
+            /* Not part of the stream, so it can't pass the filter.
+             * Frames that haven't been dissected yet (e.g. after an
+             * aborted redissection) and reference frames are still
+             * dissected as usual. */
+            frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                    &cf->provider.ref, cf->provider.prev_dis);
+            cf->provider.prev_cap = fdata;
+            fdata->passed_dfilter = 0;
+        } else {
+            if (!cf_read_record(cf, fdata, &rec, &buf))
+                break; /* error reading the frame */
+
+            add_packet_to_packet_list(fdata, cf, &edt, cf->dfcode,
+                    cinfo, &rec, &buf,
+                    add_to_packet_list);
+        }
 
         /* If this frame is displayed, and this is the first frame we've
            seen displayed after the selected frame, remember this frame -
@@ -2196,8 +2236,13 @@ typedef enum {
     PSP_FAILED
 } psp_return_t;
 
+/*
+ * If stream_frames isn't NULL, only the frames it returns, and frames
+ * that haven't been dissected yet, are processed.
+ */
 static psp_return_t
 process_specified_records(capture_file *cf, packet_range_t *range,
+        stream_frame_iter_t *stream_frames,
         const char *string1, const char *string2, bool terminate_is_stop,
         bool (*callback)(capture_file *, frame_data *,
             wtap_rec *, Buffer *, void *),
@@ -2216,6 +2261,8 @@ process_specified_records(capture_file *cf, packet_range_t *range,
     float            progbar_val;
     char             progbar_status_str[100];
     range_process_e  process_this;
+    bool             have_stream_frame = false;
+    uint32_t         stream_frame_num = 0;
 
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
@@ -2245,6 +2292,9 @@ process_specified_records(capture_file *cf, packet_range_t *range,
     if (range != NULL)
         packet_range_process_init(range);
 
+    if (stream_frames != NULL)
+        have_stream_frame = stream_frame_iter_next(stream_frames, &stream_frame_num);
+
     /* Iterate through all the packets, printing the packets that
        were selected by the current display filter.  */
     for (framenum = 1; framenum <= cf->count; framenum++) {
@@ -2303,6 +2353,16 @@ process_specified_records(capture_file *cf, packet_range_t *range,
             }
         }
 
+        if (stream_frames != NULL) {
+            while (have_stream_frame && stream_frame_num < fdata->num) {
+                have_stream_frame = stream_frame_iter_next(stream_frames, &stream_frame_num);
+            }
+            if (fdata->visited && (!have_stream_frame || stream_frame_num != fdata->num)) {
+                /* not part of the stream */
+                continue;
+            }
+        }
+
         /* Get the packet */
         if (!cf_read_record(cf, fdata, &rec, &buf)) {
             /* Attempt to get the packet failed. */
@@ -2360,6 +2420,8 @@ cf_retap_packets(capture_file *cf)
     bool                  create_proto_tree;
     bool                  filtering_tap_listeners;
     unsigned              tap_flags;
+    bool                  use_stream_frames;
+    stream_frame_iter_t   stream_frames;
     psp_return_t          ret;
 
     /* Presumably the user closed the capture file. */
@@ -2449,7 +2511,16 @@ cf_retap_packets(capture_file *cf)
         range.process = range_process_user_range;
     }
 
-    ret = process_specified_records(cf, &range, "Recalculating statistics on",
+    /*
+     * If the tap listeners only want the frames of one stream, e.g.
+     * Follow Stream, only the frames recorded for that stream on the
+     * first pass can be tapped; don't read or dissect any of the others.
+     */
+    use_stream_frames = stream_frame_index_filter_iter(tap_listeners_common_filter(), &stream_frames);
+
+    ret = process_specified_records(cf, &range,
+            use_stream_frames ? &stream_frames : NULL,
+            "Recalculating statistics on",
             "all packets", true, retap_packet,
             &callback_args, true);
 
@@ -2788,7 +2859,7 @@ cf_print_packets(capture_file *cf, print_args_t *print_args,
 
     /* Iterate through the list of packets, printing the packets we were
        told to print. */
-    ret = process_specified_records(cf, &print_args->range, "Printing",
+    ret = process_specified_records(cf, &print_args->range, NULL, "Printing",
             "selected packets", true, print_packet,
             &callback_args, show_progress_bar);
     epan_dissect_cleanup(&callback_args.edt);
@@ -2883,7 +2954,7 @@ cf_write_pdml_packets(capture_file *cf, print_args_t *print_args)
 
     /* Iterate through the list of packets, printing the packets we were
        told to print. */
-    ret = process_specified_records(cf, &print_args->range, "Writing PDML",
+    ret = process_specified_records(cf, &print_args->range, NULL, "Writing PDML",
             "selected packets", true,
             write_pdml_packet, &callback_args, true);
 
@@ -2967,7 +3038,7 @@ cf_write_psml_packets(capture_file *cf, print_args_t *print_args)
 
     /* Iterate through the list of packets, printing the packets we were
        told to print. */
-    ret = process_specified_records(cf, &print_args->range, "Writing PSML",
+    ret = process_specified_records(cf, &print_args->range, NULL, "Writing PSML",
             "selected packets", true,
             write_psml_packet, &callback_args, true);
 
@@ -3049,7 +3120,7 @@ cf_write_csv_packets(capture_file *cf, print_args_t *print_args)
 
     /* Iterate through the list of packets, printing the packets we were
        told to print. */
-    ret = process_specified_records(cf, &print_args->range, "Writing CSV",
+    ret = process_specified_records(cf, &print_args->range, NULL, "Writing CSV",
             "selected packets", true,
             write_csv_packet, &callback_args, true);
 
@@ -3115,7 +3186,7 @@ cf_write_carrays_packets(capture_file *cf, print_args_t *print_args)
 
     /* Iterate through the list of packets, printing the packets we were
        told to print. */
-    ret = process_specified_records(cf, &print_args->range,
+    ret = process_specified_records(cf, &print_args->range, NULL,
             "Writing C Arrays",
             "selected packets", true,
             carrays_write_packet, &callback_args, true);
@@ -3184,7 +3255,7 @@ cf_write_json_packets(capture_file *cf, print_args_t *print_args)
 
     /* Iterate through the list of packets, printing the packets we were
        told to print. */
-    ret = process_specified_records(cf, &print_args->range, "Writing JSON",
+    ret = process_specified_records(cf, &print_args->range, NULL, "Writing JSON",
             "selected packets", true,
             write_json_packet, &callback_args, true);
 
@@ -3567,8 +3638,30 @@ typedef struct {
     const uint8_t *data;
     size_t        data_len;
     ws_mempbrk_pattern *pattern;
+    wtap          *wth;     /* Set for search workers; see find_packet_data() */
 } cbs_t;    /* "Counted byte string" */
 
+/*
+ * Load the frame's data for one of the raw data match functions.
+ * Search workers read through their own wiretap handle and leave
+ * reporting read errors to the main thread.
+ */
+static bool
+match_read_data(capture_file *cf, const frame_data *fdata,
+        wtap_rec *rec, Buffer *buf, const cbs_t *info)
+{
+    int    err;
+    char *err_info;
+
+    if (info->wth == NULL) {
+        return cf_read_record(cf, fdata, rec, buf);
+    }
+    if (!wtap_seek_read(info->wth, fdata->file_off, rec, buf, &err, &err_info)) {
+        g_free(err_info);
+        return false;
+    }
+    return true;
+}
 
 /*
  * The current match_* routines only support ASCII case insensitivity and don't
@@ -3596,6 +3689,8 @@ cf_find_packet_data(capture_file *cf, const uint8_t *string, size_t string_size,
 
     info.data = string;
     info.data_len = string_size;
+    info.pattern = NULL;
+    info.wth = NULL;
 
     /* Regex, String or hex search? */
     if (cf->regex) {
@@ -3676,7 +3771,7 @@ cf_find_packet_data(capture_file *cf, const uint8_t *string, size_t string_size,
     }
     cf->search_pos = 0; /* Reset the position */
     cf->search_len = 0; /* Reset length */
-    return find_packet(cf, match_function, &info, dir);
+    return find_packet_data(cf, match_function, &info, dir);
 }
 
 static match_result
@@ -3694,7 +3789,7 @@ match_narrow_and_wide(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -3769,7 +3864,7 @@ match_narrow_and_wide_reverse(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -3850,7 +3945,7 @@ match_narrow_and_wide_case(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -3928,7 +4023,7 @@ match_narrow_and_wide_case_reverse(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4011,7 +4106,7 @@ match_narrow_case(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4068,7 +4163,7 @@ match_narrow_case_reverse(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4128,7 +4223,7 @@ match_wide(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4184,7 +4279,7 @@ match_wide_reverse(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4246,7 +4341,7 @@ match_wide_case(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4306,7 +4401,7 @@ match_wide_case_reverse(capture_file *cf, frame_data *fdata,
     size_t        c_match    = 0;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4363,7 +4458,7 @@ match_binary(capture_file *cf, frame_data *fdata,
     const uint8_t *pd = NULL, *buf_start;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4398,7 +4493,7 @@ match_binary_reverse(capture_file *cf, frame_data *fdata,
     const uint8_t *pd = NULL, *buf_start;
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, info)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4431,13 +4526,13 @@ match_binary_reverse(capture_file *cf, frame_data *fdata,
 
 static match_result
 match_regex(capture_file *cf, frame_data *fdata,
-        wtap_rec *rec, Buffer *buf, void *criterion _U_)
+        wtap_rec *rec, Buffer *buf, void *criterion)
 {
     match_result  result = MR_NOTMATCHED;
     size_t result_pos[2] = {0, 0};
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, (cbs_t *)criterion)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4467,13 +4562,13 @@ match_regex(capture_file *cf, frame_data *fdata,
 
 static match_result
 match_regex_reverse(capture_file *cf, frame_data *fdata,
-        wtap_rec *rec, Buffer *buf, void *criterion _U_)
+        wtap_rec *rec, Buffer *buf, void *criterion)
 {
     match_result  result = MR_NOTMATCHED;
     size_t result_pos[2] = {0, 0};
 
     /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata, rec, buf)) {
+    if (!match_read_data(cf, fdata, rec, buf, (cbs_t *)criterion)) {
         /* Attempt to get the packet failed. */
         return MR_ERROR;
     }
@@ -4585,6 +4680,39 @@ match_time_reference(capture_file *cf _U_, frame_data *fdata, wtap_rec *rec _U_,
     return fdata->ref_time ? MR_MATCHED : MR_NOTMATCHED;
 }
 
+/*
+ * Select the packet list row for the frame a search found, if any.
+ */
+static bool
+select_found_packet(capture_file *cf, frame_data *new_fd)
+{
+    bool succeeded;
+
+    if (new_fd != NULL) {
+        /* We found a frame that's displayed and that matches.
+           Try to find and select the packet summary list row for that frame. */
+        bool found_row;
+
+        cf->search_in_progress = true;
+        found_row = packet_list_select_row_from_data(new_fd);
+        cf->search_in_progress = false;
+        if (!found_row) {
+            /* We didn't find a row corresponding to this frame.
+               This means that the frame isn't being displayed currently,
+               so we can't select it. */
+            cf->search_pos = 0; /* Reset the position */
+            cf->search_len = 0; /* Reset length */
+            simple_message_box(ESD_TYPE_INFO, NULL,
+                    "The capture file is probably not fully dissected.",
+                    "End of capture exceeded.");
+            succeeded = false; /* The search succeeded but we didn't find the row */
+        } else
+            succeeded = true; /* The search succeeded and we found the row */
+    } else
+        succeeded = false;   /* The search failed */
+    return succeeded;
+}
+
 static bool
 find_packet(capture_file *cf, ws_match_function match_function,
         void *criterion, search_direction dir)
@@ -4599,7 +4727,6 @@ find_packet(capture_file *cf, ws_match_function match_function,
     progdlg_t   *progbar = NULL;
     GTimer      *prog_timer = g_timer_new();
     int          count;
-    bool         succeeded;
     float        progbar_val;
     char         status_str[100];
     match_result result;
@@ -4732,31 +4859,326 @@ find_packet(capture_file *cf, ws_match_function match_function,
         destroy_progress_dlg(progbar);
     g_timer_destroy(prog_timer);
 
-    if (new_fd != NULL) {
-        /* We found a frame that's displayed and that matches.
-           Try to find and select the packet summary list row for that frame. */
-        bool found_row;
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    return select_found_packet(cf, new_fd);
+}
 
-        cf->search_in_progress = true;
-        found_row = packet_list_select_row_from_data(new_fd);
-        cf->search_in_progress = false;
-        if (!found_row) {
-            /* We didn't find a row corresponding to this frame.
-               This means that the frame isn't being displayed currently,
-               so we can't select it. */
-            cf->search_pos = 0; /* Reset the position */
-            cf->search_len = 0; /* Reset length */
-            simple_message_box(ESD_TYPE_INFO, NULL,
-                    "The capture file is probably not fully dissected.",
-                    "End of capture exceeded.");
-            succeeded = false; /* The search succeeded but we didn't find the row */
-        } else
-            succeeded = true; /* The search succeeded and we found the row */
-    } else
-        succeeded = false;   /* The search failed */
+/*
+ * Searching the raw packet data doesn't need dissection, so for large
+ * files the data match functions are run on worker threads, each with
+ * its own wiretap handle for the file.  The frames are handed out in
+ * chunks in search order, and the search stops at the first match in
+ * that order.  Searches that need the protocol tree stay sequential.
+ */
+#define PARALLEL_SEARCH_MIN_FRAMES  20000
+#define PARALLEL_SEARCH_CHUNK_SIZE  4096
+#define PARALLEL_SEARCH_MAX_THREADS 8
+
+typedef enum {
+    PS_FALLBACK,    /* Couldn't search in parallel; search sequentially */
+    PS_FOUND,
+    PS_NOT_FOUND,
+    PS_STOPPED
+} parallel_search_result;
+
+typedef struct {
+    capture_file      *cf;
+    ws_match_function  match_function;
+    const cbs_t       *info;
+    /* The search order is seg1_len frames from seg1_start followed by
+       seg2_len frames from seg2_start, each counting up or down. */
+    bool               forward;
+    uint32_t           seg1_start;
+    uint32_t           seg1_len;
+    uint32_t           seg2_start;
+    uint32_t           seg2_len;
+    int                n_chunks;
+    int                next_chunk;  /* Accessed atomically */
+    int                scanned;     /* Accessed atomically */
+    int                hit_pos;     /* Accessed atomically, G_MAXINT if none */
+    int                abort;       /* Accessed atomically */
+    GMutex             mutex;
+    GCond              cond;
+    unsigned           running;
+    bool               failed;
+} parallel_search_t;
+
+static uint32_t
+parallel_search_framenum(const parallel_search_t *ps, uint32_t pos)
+{
+    uint32_t start = ps->seg1_start;
+
+    if (pos >= ps->seg1_len) {
+        start = ps->seg2_start;
+        pos -= ps->seg1_len;
+    }
+    return ps->forward ? start + pos : start - pos;
+}
+
+static void *
+parallel_search_worker(void *data)
+{
+    parallel_search_t *ps = (parallel_search_t *)data;
+    /* The match functions save the match position in the capture_file,
+       so each worker gets its own copy. */
+    capture_file wcf = *ps->cf;
+    cbs_t        info = *ps->info;
+    uint32_t     total = ps->seg1_len + ps->seg2_len;
+    wtap_rec     rec;
+    Buffer       buf;
+    int          err;
+    char        *err_info;
+    bool         failed = false;
+    bool         done = false;
+
+    info.wth = wtap_open_offline(ps->cf->filename, ps->cf->open_type, &err, &err_info, true);
+    if (info.wth == NULL) {
+        g_free(err_info);
+        failed = true;
+        done = true;
+    }
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    while (!done) {
+        int chunk = g_atomic_int_add(&ps->next_chunk, 1);
+        uint32_t first, last, pos;
+
+        if (chunk >= ps->n_chunks)
+            break;
+        first = (uint32_t)chunk * PARALLEL_SEARCH_CHUNK_SIZE;
+        last = MIN(first + PARALLEL_SEARCH_CHUNK_SIZE, total);
+        for (pos = first; pos < last; pos++) {
+            frame_data  *fdata;
+            match_result result;
+
+            /* Chunks are handed out in order, so once we're past a match
+               nothing this worker could still find would be used. */
+            if (g_atomic_int_get(&ps->abort) ||
+                (int)pos > g_atomic_int_get(&ps->hit_pos)) {
+                done = true;
+                break;
+            }
+            fdata = frame_data_sequence_find(wcf.provider.frames, parallel_search_framenum(ps, pos));
+            if (fdata == NULL || !fdata->passed_dfilter)
+                continue;
+            wcf.search_pos = 0;
+            wcf.search_len = 0;
+            result = (*ps->match_function)(&wcf, fdata, &rec, &buf, &info);
+            wtap_rec_reset(&rec);
+            if (result == MR_ERROR) {
+                failed = true;
+                done = true;
+                break;
+            } else if (result == MR_MATCHED) {
+                g_mutex_lock(&ps->mutex);
+                if ((int)pos < g_atomic_int_get(&ps->hit_pos))
+                    g_atomic_int_set(&ps->hit_pos, (int)pos);
+                g_mutex_unlock(&ps->mutex);
+                done = true;
+                break;
+            }
+        }
+        g_atomic_int_add(&ps->scanned, (int)(pos - first));
+    }
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
-    return succeeded;
+    if (info.wth != NULL)
+        wtap_close(info.wth);
+
+    g_mutex_lock(&ps->mutex);
+    if (failed) {
+        ps->failed = true;
+        g_atomic_int_set(&ps->abort, 1);
+    }
+    ps->running--;
+    g_cond_signal(&ps->cond);
+    g_mutex_unlock(&ps->mutex);
+    return NULL;
+}
+
+/*
+ * Look for the first frame after the current one, in search order, that
+ * matches.  Read errors, including not being able to open the file again,
+ * make us give up so that the sequential search can report them.
+ */
+static parallel_search_result
+find_packet_data_parallel(capture_file *cf, ws_match_function match_function,
+        const cbs_t *info, search_direction dir, frame_data **found_fd)
+{
+    parallel_search_t ps;
+    uint32_t     prev_framenum;
+    unsigned     n_threads;
+    GThread    **threads;
+    progdlg_t   *progbar = NULL;
+    GTimer      *prog_timer;
+    float        progbar_val = 0.0f;
+    char         status_str[100];
+    bool         stopped = false;
+
+    *found_fd = NULL;
+    n_threads = MIN(g_get_num_processors(), PARALLEL_SEARCH_MAX_THREADS);
+    if (n_threads < 2 || cf->count < PARALLEL_SEARCH_MIN_FRAMES)
+        return PS_FALLBACK;
+    /* Workers reopen the file, so it has to be completely read and be
+       something we can open again. */
+    if (cf->state != FILE_READ_DONE || cf->filename == NULL ||
+        strcmp(cf->filename, "-") == 0)
+        return PS_FALLBACK;
+    /* Seeking in a compressed file means decompressing from the last
+       fast seek point, so several readers scattered over the file are
+       slower than one reading it in order. */
+    if (cf->provider.wth == NULL ||
+        wtap_get_compression_type(cf->provider.wth) != WTAP_UNCOMPRESSED)
+        return PS_FALLBACK;
+
+    prev_framenum = cf->current_frame ? cf->current_frame->num : 0;
+
+    /* Lay out the frames in the order find_packet() would visit them.
+       It ends with the starting frame, either after wrapping around or
+       by going back to it. */
+    memset(&ps, 0, sizeof ps);
+    ps.cf = cf;
+    ps.match_function = match_function;
+    ps.info = info;
+    ps.forward = (dir != SD_BACKWARD);
+    if (ps.forward) {
+        ps.seg1_start = prev_framenum + 1;
+        ps.seg1_len = cf->count - prev_framenum;
+        if (prefs.gui_find_wrap) {
+            ps.seg2_start = 1;
+            ps.seg2_len = prev_framenum;
+        }
+    } else {
+        ps.seg1_start = prev_framenum - 1;
+        ps.seg1_len = prev_framenum > 0 ? prev_framenum - 1 : 0;
+        if (prefs.gui_find_wrap) {
+            ps.seg2_start = cf->count;
+            ps.seg2_len = prev_framenum > 0 ? cf->count - prev_framenum + 1 : cf->count;
+        }
+    }
+    if (!prefs.gui_find_wrap && prev_framenum > 0) {
+        ps.seg2_start = prev_framenum;
+        ps.seg2_len = 1;
+    }
+    ps.n_chunks = (int)((ps.seg1_len + ps.seg2_len + PARALLEL_SEARCH_CHUNK_SIZE - 1) / PARALLEL_SEARCH_CHUNK_SIZE);
+    ps.hit_pos = G_MAXINT;
+    g_mutex_init(&ps.mutex);
+    g_cond_init(&ps.cond);
+
+    cf->stop_flag = false;
+
+    threads = g_new(GThread *, n_threads);
+    ps.running = n_threads;
+    for (unsigned i = 0; i < n_threads; i++) {
+        threads[i] = g_thread_new("Packet search", parallel_search_worker, &ps);
+    }
+
+    prog_timer = g_timer_new();
+    g_mutex_lock(&ps.mutex);
+    while (ps.running > 0) {
+        int64_t end_time = g_get_monotonic_time() + (int64_t)(PROGBAR_UPDATE_INTERVAL * G_TIME_SPAN_SECOND);
+
+        if (g_cond_wait_until(&ps.cond, &ps.mutex, end_time))
+            continue;
+
+        /* Keep the UI going while the workers search. */
+        g_mutex_unlock(&ps.mutex);
+        if (progbar == NULL)
+            progbar = delayed_create_progress_dlg(cf->window, NULL, NULL,
+                    false, &cf->stop_flag, progbar_val);
+        if (g_timer_elapsed(prog_timer, NULL) > PROGBAR_UPDATE_INTERVAL) {
+            int count = g_atomic_int_get(&ps.scanned);
+
+            progbar_val = (float) count / cf->count;
+            snprintf(status_str, sizeof(status_str),
+                    "%4u of %u packets", count, cf->count);
+            update_progress_dlg(progbar, progbar_val, status_str);
+            g_timer_start(prog_timer);
+        }
+        if (cf->stop_flag && !stopped) {
+            stopped = true;
+            g_atomic_int_set(&ps.abort, 1);
+        }
+        g_mutex_lock(&ps.mutex);
+    }
+    g_mutex_unlock(&ps.mutex);
+
+    for (unsigned i = 0; i < n_threads; i++) {
+        g_thread_join(threads[i]);
+    }
+    g_free(threads);
+    if (progbar != NULL)
+        destroy_progress_dlg(progbar);
+    g_timer_destroy(prog_timer);
+    g_mutex_clear(&ps.mutex);
+    g_cond_clear(&ps.cond);
+
+    if (stopped)
+        return PS_STOPPED;
+    if (ps.failed)
+        return PS_FALLBACK;
+
+    if (ps.hit_pos == G_MAXINT || (uint32_t)ps.hit_pos >= ps.seg1_len) {
+        if (ps.forward) {
+            statusbar_push_temporary_msg(prefs.gui_find_wrap ?
+                    "Search reached the end. Continuing at beginning." :
+                    "Search reached the end.");
+        } else {
+            statusbar_push_temporary_msg(prefs.gui_find_wrap ?
+                    "Search reached the beginning. Continuing at end." :
+                    "Search reached the beginning.");
+        }
+    }
+    if (ps.hit_pos == G_MAXINT)
+        return PS_NOT_FOUND;
+
+    *found_fd = frame_data_sequence_find(cf->provider.frames,
+            parallel_search_framenum(&ps, (uint32_t)ps.hit_pos));
+    return (*found_fd != NULL) ? PS_FOUND : PS_FALLBACK;
+}
+
+static bool
+find_packet_data(capture_file *cf, ws_match_function match_function,
+        void *criterion, search_direction dir)
+{
+    frame_data  *new_fd;
+    wtap_rec     rec;
+    Buffer       buf;
+    match_result result;
+
+    switch (find_packet_data_parallel(cf, match_function, (const cbs_t *)criterion, dir, &new_fd)) {
+
+    case PS_FALLBACK:
+        return find_packet(cf, match_function, criterion, dir);
+
+    case PS_STOPPED:
+        /* Go back to the frame where we started. */
+        return select_found_packet(cf, cf->current_frame);
+
+    case PS_NOT_FOUND:
+        return false;
+
+    case PS_FOUND:
+        break;
+    }
+
+    /* Match the frame again here, through the capture file's own handle,
+       to get the position to highlight. */
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    result = (*match_function)(cf, new_fd, &rec, &buf, criterion);
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    if (result == MR_ERROR) {
+        /* Error; the match function has reported the error.  Go back to the
+           frame where we started. */
+        new_fd = cf->current_frame;
+    } else if (result == MR_NOTMATCHED) {
+        return find_packet(cf, match_function, criterion, dir);
+    }
+    return select_found_packet(cf, new_fd);
 }
 
 bool
@@ -5719,7 +6141,7 @@ cf_save_records(capture_file *cf, const char *fname, unsigned save_format,
         callback_args.pdh = pdh;
         callback_args.fname = fname;
         callback_args.file_type = save_format;
-        switch (process_specified_records(cf, NULL, "Saving", "packets",
+        switch (process_specified_records(cf, NULL, NULL, "Saving", "packets",
                     true, save_record, &callback_args, true)) {
 
             case PSP_FINISHED:
@@ -5984,7 +6406,7 @@ cf_export_specified_packets(capture_file *cf, const char *fname,
     callback_args.pdh = pdh;
     callback_args.fname = fname;
     callback_args.file_type = save_format;
-    switch (process_specified_records(cf, range, "Writing", "specified records",
+    switch (process_specified_records(cf, range, NULL, "Writing", "specified records",
                 true, save_record, &callback_args, true)) {
 
         case PSP_FINISHED:
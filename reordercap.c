@@ -11,6 +11,7 @@
 #include <config.h>
 #define WS_LOG_DOMAIN  LOG_DOMAIN_MAIN
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,10 +22,12 @@
 
 #include <wiretap/wtap.h>
 
+#include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/file_util.h>
 #include <wsutil/privileges.h>
+#include <wsutil/tempfile.h>
 #include <cli_main.h>
 #include <wsutil/version_info.h>
 #include <wiretap/wtap_opttypes.h>
@@ -49,6 +52,9 @@ print_usage(FILE *output)
     fprintf(output, "Usage: reordercap [options] <infile> <outfile>\n");
     fprintf(output, "\n");
     fprintf(output, "Options:\n");
+    fprintf(output, "  -m <frames>       keep at most <frames> frame records in memory; beyond\n");
+    fprintf(output, "                    that, frames are written in sorted runs to temporary\n");
+    fprintf(output, "                    files and merged when writing the output file.\n");
     fprintf(output, "  -n                don't write to output file if the input file is ordered.\n");
     fprintf(output, "  -h, --help        display this help and exit.\n");
     fprintf(output, "  -v, --version     print version information and exit.\n");
@@ -62,6 +68,34 @@ typedef struct FrameRecord_t {
     nstime_t     frame_time;
 } FrameRecord_t;
 
+/* A sorted run of frame records spilled to a temporary file. The file
+   is only kept open while the run is being written or merged. */
+typedef struct FrameRun_t {
+    FILE          *fp;
+    char          *path;
+    FrameRecord_t  last;    /* Last record written to the run */
+    FrameRecord_t  head;    /* Next record to be merged */
+} FrameRun_t;
+
+/* A frame record waiting in the replacement selection heap, tagged
+   with the number of the run it will be written to */
+typedef struct RunHeapEntry_t {
+    unsigned       run;
+    FrameRecord_t  frame;
+} RunHeapEntry_t;
+
+/* Replacement selection state used once the in-memory limit is reached */
+typedef struct RunSelect_t {
+    RunHeapEntry_t *heap;
+    unsigned        count;
+    unsigned        run;    /* Number of the run being written */
+    FrameRun_t     *out;    /* Run being written */
+} RunSelect_t;
+
+/* Maximum number of runs merged (and so open) at once. If there are more
+   runs than this, they are merged in several passes. */
+#define MAX_MERGE_RUNS 64
+
 
 /**************************************************/
 /* Debugging only                                 */
@@ -119,17 +153,353 @@ frame_write(FrameRecord_t *frame, wtap *wth, wtap_dumper *pdh,
    negative if (t1 < t2)
    zero     if (t1 == t2)
    positive if (t1 > t2)
+   Frames with equal timestamps keep their original order.
 */
 static int
 frames_compare(const void *a, const void *b)
 {
-    const FrameRecord_t *frame1 = *(const FrameRecord_t *const *) a;
-    const FrameRecord_t *frame2 = *(const FrameRecord_t *const *) b;
+    const FrameRecord_t *frame1 = (const FrameRecord_t *) a;
+    const FrameRecord_t *frame2 = (const FrameRecord_t *) b;
+    int cmp;
+
+    cmp = nstime_cmp(&frame1->frame_time, &frame2->frame_time);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return (frame1->num > frame2->num) - (frame1->num < frame2->num);
+}
+
+/* Start a new run in a temporary file */
+static FrameRun_t *
+run_new(GPtrArray *runs)
+{
+    FrameRun_t *run;
+    GError *gerr = NULL;
+    int fd;
+
+    run = g_new0(FrameRun_t, 1);
+    fd = create_tempfile(NULL, &run->path, "reordercap", NULL, &gerr);
+    if (fd == -1) {
+        fprintf(stderr, "reordercap: Can't create temporary file: %s\n",
+                gerr->message);
+        g_error_free(gerr);
+        g_free(run->path);
+        g_free(run);
+        return NULL;
+    }
+    run->fp = ws_fdopen(fd, "wb");
+    if (run->fp == NULL) {
+        fprintf(stderr, "reordercap: Can't open temporary file \"%s\": %s\n",
+                run->path, g_strerror(errno));
+        ws_close(fd);
+        ws_unlink(run->path);
+        g_free(run->path);
+        g_free(run);
+        return NULL;
+    }
+    g_ptr_array_add(runs, run);
+    DEBUG_PRINT("Starting run %u in %s\n", runs->len, run->path);
+    return run;
+}
+
+static bool
+run_write(FrameRun_t *run, const FrameRecord_t *frame)
+{
+    if (fwrite(frame, sizeof(FrameRecord_t), 1, run->fp) != 1) {
+        fprintf(stderr, "reordercap: Can't write temporary file \"%s\": %s\n",
+                run->path, g_strerror(errno));
+        return false;
+    }
+    run->last = *frame;
+    return true;
+}
+
+/* Close a run once it has been completely written or merged */
+static bool
+run_close(FrameRun_t *run)
+{
+    int ret = fclose(run->fp);
+
+    run->fp = NULL;
+    if (ret != 0) {
+        fprintf(stderr, "reordercap: Can't close temporary file \"%s\": %s\n",
+                run->path, g_strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void
+run_free(void *data)
+{
+    FrameRun_t *run = (FrameRun_t *)data;
+
+    if (run->fp != NULL) {
+        fclose(run->fp);
+    }
+    ws_unlink(run->path);
+    g_free(run->path);
+    g_free(run);
+}
+
+/* Order heap entries by run first, then by frame */
+static int
+run_entry_compare(const RunHeapEntry_t *entry1, const RunHeapEntry_t *entry2)
+{
+    if (entry1->run != entry2->run) {
+        return entry1->run < entry2->run ? -1 : 1;
+    }
+    return frames_compare(&entry1->frame, &entry2->frame);
+}
+
+/* Restore the min-heap property for the entry at position pos */
+static void
+run_select_sift_down(RunHeapEntry_t *heap, unsigned count, unsigned pos)
+{
+    for (;;) {
+        unsigned smallest = pos;
+        unsigned left = 2 * pos + 1;
+        unsigned right = left + 1;
+        RunHeapEntry_t tmp;
+
+        if (left < count && run_entry_compare(&heap[left], &heap[smallest]) < 0) {
+            smallest = left;
+        }
+        if (right < count && run_entry_compare(&heap[right], &heap[smallest]) < 0) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        tmp = heap[pos];
+        heap[pos] = heap[smallest];
+        heap[smallest] = tmp;
+        pos = smallest;
+    }
+}
+
+/* Move the frame records held in memory into the replacement selection
+   heap; from now on they are written out to runs as new frames arrive. */
+static void
+run_select_init(RunSelect_t *sel, GArray *frames)
+{
+    unsigned i;
+
+    sel->heap = g_new(RunHeapEntry_t, frames->len);
+    sel->count = frames->len;
+    sel->run = 0;
+    sel->out = NULL;
+    for (i = 0; i < frames->len; i++) {
+        sel->heap[i].run = 0;
+        sel->heap[i].frame = g_array_index(frames, FrameRecord_t, i);
+    }
+    for (i = sel->count / 2; i > 0; i--) {
+        run_select_sift_down(sel->heap, sel->count, i - 1);
+    }
+    g_array_set_size(frames, 0);
+}
+
+/* Write the smallest frame in the heap to its run */
+static bool
+run_select_output(GPtrArray *runs, RunSelect_t *sel)
+{
+    RunHeapEntry_t *top = &sel->heap[0];
+
+    if (sel->out == NULL || top->run != sel->run) {
+        if (sel->out != NULL && !run_close(sel->out)) {
+            return false;
+        }
+        sel->out = run_new(runs);
+        if (sel->out == NULL) {
+            return false;
+        }
+        sel->run = top->run;
+    }
+    return run_write(sel->out, &top->frame);
+}
+
+/* Replacement selection: write out the smallest frame and put the new one
+   in its place. A frame that sorts after the one just written can still
+   go in the current run, so runs are on average twice the in-memory
+   limit for random input, and a file whose frames are never displaced
+   further than the limit comes out as a single run. */
+static bool
+run_select_push(GPtrArray *runs, RunSelect_t *sel, const FrameRecord_t *frame)
+{
+    if (!run_select_output(runs, sel)) {
+        return false;
+    }
+    sel->heap[0].frame = *frame;
+    sel->heap[0].run = sel->run;
+    if (frames_compare(frame, &sel->out->last) < 0) {
+        /* Too early for the current run; hold it for the next one */
+        sel->heap[0].run++;
+    }
+    run_select_sift_down(sel->heap, sel->count, 0);
+    return true;
+}
+
+/* Write out whatever is left in the heap at the end of the input */
+static bool
+run_select_finish(GPtrArray *runs, RunSelect_t *sel)
+{
+    while (sel->count > 0) {
+        if (!run_select_output(runs, sel)) {
+            return false;
+        }
+        sel->heap[0] = sel->heap[--sel->count];
+        run_select_sift_down(sel->heap, sel->count, 0);
+    }
+    if (sel->out != NULL) {
+        FrameRun_t *out = sel->out;
+
+        sel->out = NULL;
+        return run_close(out);
+    }
+    return true;
+}
+
+/* Restore the min-heap property for the run at position pos */
+static void
+run_heap_sift_down(FrameRun_t **heap, unsigned count, unsigned pos)
+{
+    for (;;) {
+        unsigned smallest = pos;
+        unsigned left = 2 * pos + 1;
+        unsigned right = left + 1;
+        FrameRun_t *tmp;
+
+        if (left < count && frames_compare(&heap[left]->head, &heap[smallest]->head) < 0) {
+            smallest = left;
+        }
+        if (right < count && frames_compare(&heap[right]->head, &heap[smallest]->head) < 0) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        tmp = heap[pos];
+        heap[pos] = heap[smallest];
+        heap[smallest] = tmp;
+        pos = smallest;
+    }
+}
+
+/* Read the next record of a run being merged. Returns false, with
+   *err set, if the run couldn't be read. */
+static bool
+run_read_head(FrameRun_t *run, bool *err)
+{
+    *err = false;
+    if (fread(&run->head, sizeof(FrameRecord_t), 1, run->fp) == 1) {
+        return true;
+    }
+    if (ferror(run->fp)) {
+        fprintf(stderr, "reordercap: Can't read temporary file \"%s\": %s\n",
+                run->path, g_strerror(errno));
+        *err = true;
+    }
+    return false;
+}
+
+/* Merge num_runs sorted runs. Only the head record of each run is held
+   in memory. The merged frames are appended to the run out if it is
+   not NULL, otherwise they are written to the output file. */
+static bool
+runs_merge(FrameRun_t **merge, unsigned num_runs, FrameRun_t *out,
+           wtap *wth, wtap_dumper *pdh, const char *infile,
+           const char *outfile)
+{
+    FrameRun_t **heap;
+    unsigned count = 0;
+    unsigned i;
+    bool read_err;
+    bool ok = true;
+    wtap_rec rec;
+    Buffer buf;
 
-    const nstime_t *time1 = &frame1->frame_time;
-    const nstime_t *time2 = &frame2->frame_time;
+    heap = g_new(FrameRun_t *, num_runs);
+    for (i = 0; i < num_runs; i++) {
+        FrameRun_t *run = merge[i];
 
-    return nstime_cmp(time1, time2);
+        run->fp = ws_fopen(run->path, "rb");
+        if (run->fp == NULL) {
+            fprintf(stderr, "reordercap: Can't open temporary file \"%s\": %s\n",
+                    run->path, g_strerror(errno));
+            g_free(heap);
+            return false;
+        }
+        if (run_read_head(run, &read_err)) {
+            heap[count++] = run;
+        } else if (read_err) {
+            g_free(heap);
+            return false;
+        }
+    }
+    for (i = count / 2; i > 0; i--) {
+        run_heap_sift_down(heap, count, i - 1);
+    }
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    while (count > 0) {
+        FrameRun_t *run = heap[0];
+
+        if (out != NULL) {
+            if (!run_write(out, &run->head)) {
+                ok = false;
+                break;
+            }
+        } else {
+            frame_write(&run->head, wth, pdh, &rec, &buf, infile, outfile);
+        }
+
+        if (!run_read_head(run, &read_err)) {
+            if (read_err) {
+                ok = false;
+                break;
+            }
+            /* This run is exhausted */
+            heap[0] = heap[--count];
+        }
+        run_heap_sift_down(heap, count, 0);
+    }
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    g_free(heap);
+
+    for (i = 0; i < num_runs; i++) {
+        if (merge[i]->fp != NULL) {
+            fclose(merge[i]->fp);
+            merge[i]->fp = NULL;
+        }
+    }
+    return ok;
+}
+
+/* Merge the sorted runs, writing each frame in turn. While there are more
+   runs than can be merged at once, the oldest ones are merged into a new
+   run, so no more than MAX_MERGE_RUNS + 1 temporary files are open. */
+static bool
+runs_merge_write(GPtrArray *runs, wtap *wth, wtap_dumper *pdh,
+                 const char *infile, const char *outfile)
+{
+    while (runs->len > MAX_MERGE_RUNS) {
+        FrameRun_t *out = run_new(runs);
+
+        if (out == NULL) {
+            return false;
+        }
+        DEBUG_PRINT("Merging %u of %u runs\n", MAX_MERGE_RUNS, runs->len - 1);
+        if (!runs_merge((FrameRun_t **)runs->pdata, MAX_MERGE_RUNS, out,
+                        wth, pdh, infile, outfile) ||
+            !run_close(out)) {
+            return false;
+        }
+        g_ptr_array_remove_range(runs, 0, MAX_MERGE_RUNS);
+    }
+    return runs_merge((FrameRun_t **)runs->pdata, runs->len, NULL,
+                      wth, pdh, infile, outfile);
 }
 
 /*
@@ -186,8 +556,12 @@ main(int argc, char *argv[])
     wtap_dump_params params;
     int                          ret = EXIT_SUCCESS;
 
-    GPtrArray *frames;
-    FrameRecord_t *prevFrame = NULL;
+    GArray *frames;
+    GPtrArray *runs = NULL;
+    unsigned frame_count = 0;
+    unsigned max_frames_in_memory = 0;
+    RunSelect_t sel = { NULL, 0, 0, NULL };
+    FrameRecord_t prevFrame = { 0, 0, NSTIME_INIT_ZERO };
 
     int opt;
     static const struct ws_option long_options[] = {
@@ -234,8 +608,11 @@ main(int argc, char *argv[])
     wtap_init(true);
 
     /* Process the options first */
-    while ((opt = ws_getopt_long(argc, argv, "hnv", long_options, NULL)) != -1) {
+    while ((opt = ws_getopt_long(argc, argv, "hm:nv", long_options, NULL)) != -1) {
         switch (opt) {
+            case 'm':
+                max_frames_in_memory = get_nonzero_uint32(ws_optarg, "frame record limit");
+                break;
             case 'n':
                 write_output_regardless = false;
                 break;
@@ -276,31 +653,45 @@ main(int argc, char *argv[])
     }
     DEBUG_PRINT("file_type_subtype is %d\n", wtap_file_type_subtype(wth));
 
-    /* Allocate the array of frame pointers. */
-    frames = g_ptr_array_new();
+    /* Allocate the array of frame records. */
+    frames = g_array_new(FALSE, FALSE, sizeof(FrameRecord_t));
+    if (max_frames_in_memory > 0) {
+        runs = g_ptr_array_new_with_free_func(run_free);
+    }
 
     /* Read each frame from infile */
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
     while (wtap_read(wth, &rec, &buf, &err, &err_info, &data_offset)) {
-        FrameRecord_t *newFrameRecord;
+        FrameRecord_t newFrameRecord;
 
-        newFrameRecord = g_slice_new(FrameRecord_t);
-        newFrameRecord->num = frames->len + 1;
-        newFrameRecord->offset = data_offset;
+        newFrameRecord.num = ++frame_count;
+        newFrameRecord.offset = data_offset;
         if (rec.presence_flags & WTAP_HAS_TS) {
-            newFrameRecord->frame_time = rec.ts;
+            newFrameRecord.frame_time = rec.ts;
         } else {
-            nstime_set_unset(&newFrameRecord->frame_time);
+            nstime_set_unset(&newFrameRecord.frame_time);
         }
 
-        if (prevFrame && frames_compare(&newFrameRecord, &prevFrame) < 0) {
+        if (frame_count > 1 && frames_compare(&newFrameRecord, &prevFrame) < 0) {
            wrong_order_count++;
         }
-
-        g_ptr_array_add(frames, newFrameRecord);
         prevFrame = newFrameRecord;
         wtap_rec_reset(&rec);
+
+        if (sel.heap != NULL) {
+            /* Over the limit: feed the frame through to the runs on disk */
+            if (!run_select_push(runs, &sel, &newFrameRecord)) {
+                ret = OUTPUT_FILE_ERROR;
+                break;
+            }
+            continue;
+        }
+
+        g_array_append_val(frames, newFrameRecord);
+        if (runs != NULL && frames->len >= max_frames_in_memory) {
+            run_select_init(&sel, frames);
+        }
     }
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
@@ -308,15 +699,24 @@ main(int argc, char *argv[])
       /* Print a message noting that the read failed somewhere along the line. */
       cfile_read_failure_message(infile, err, err_info);
     }
+    if (ret == EXIT_SUCCESS && sel.heap != NULL) {
+        if (!run_select_finish(runs, &sel)) {
+            ret = OUTPUT_FILE_ERROR;
+        }
+        DEBUG_PRINT("%u sorted runs to merge\n", runs->len);
+    }
+    if (ret != EXIT_SUCCESS) {
+        goto free_frames;
+    }
 
-    printf("%u frames, %u out of order\n", frames->len, wrong_order_count);
+    printf("%u frames, %u out of order\n", frame_count, wrong_order_count);
 
     wtap_dump_params_init(&params, wth);
 
     /* Sort the frames */
     /* XXX - Does this handle multiple SHBs correctly? */
     if (wrong_order_count > 0) {
-        g_ptr_array_sort(frames, frames_compare);
+        g_array_sort(frames, frames_compare);
     }
 
 
@@ -338,24 +738,32 @@ main(int argc, char *argv[])
                                             wtap_file_type_subtype(wth));
             wtap_dump_params_cleanup(&params);
             ret = OUTPUT_FILE_ERROR;
-            goto clean_exit;
+            goto free_frames;
         }
 
 
-        /* Write out each sorted frame in turn */
-        wtap_rec_init(&rec);
-        ws_buffer_init(&buf, 1514);
-        for (i = 0; i < frames->len; i++) {
-            FrameRecord_t *frame = (FrameRecord_t *)frames->pdata[i];
+        if (runs != NULL && runs->len > 0) {
+            /* Merge the sorted runs from the temporary files */
+            if (!runs_merge_write(runs, wth, pdh, infile, outfile)) {
+                wtap_dump_close(pdh, NULL, &err, &err_info);
+                wtap_dump_params_cleanup(&params);
+                ret = OUTPUT_FILE_ERROR;
+                goto free_frames;
+            }
+        } else {
+            /* Write out each sorted frame in turn */
+            wtap_rec_init(&rec);
+            ws_buffer_init(&buf, 1514);
+            for (i = 0; i < frames->len; i++) {
+                FrameRecord_t *frame = &g_array_index(frames, FrameRecord_t, i);
 
-            frame_write(frame, wth, pdh, &rec, &buf, infile, outfile);
+                frame_write(frame, wth, pdh, &rec, &buf, infile, outfile);
+            }
 
-            g_slice_free(FrameRecord_t, frame);
+            wtap_rec_cleanup(&rec);
+            ws_buffer_free(&buf);
         }
 
-        wtap_rec_cleanup(&rec);
-        ws_buffer_free(&buf);
-
 
 
         /* Close outfile */
@@ -363,25 +771,22 @@ main(int argc, char *argv[])
             cfile_close_failure_message(outfile, err, err_info);
             wtap_dump_params_cleanup(&params);
             ret = OUTPUT_FILE_ERROR;
-            goto clean_exit;
+            goto free_frames;
         }
     } else {
         printf("Not writing output file because input file is already in order.\n");
-
-        /* Free frame memory */
-        for (i = 0; i < frames->len; i++) {
-            FrameRecord_t *frame = (FrameRecord_t *)frames->pdata[i];
-
-            g_slice_free(FrameRecord_t, frame);
-        }
     }
 
-
-    /* Free the whole array */
-    g_ptr_array_free(frames, TRUE);
-
     wtap_dump_params_cleanup(&params);
 
+free_frames:
+    /* Free the whole array, and remove any temporary files */
+    g_array_free(frames, TRUE);
+    g_free(sel.heap);
+    if (runs != NULL) {
+        g_ptr_array_free(runs, TRUE);
+    }
+
     /* Finally, close infile and release resources. */
     wtap_close(wth);
 
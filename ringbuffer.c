@@ -67,6 +67,55 @@ typedef z_stream zlib_stream;
 #endif /* HAVE_ZLIB */
 #endif
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif /* HAVE_ZSTD */
+
+#ifdef HAVE_LZ4FRAME_H
+#include <lz4frame.h>
+#endif /* HAVE_LZ4FRAME_H */
+
+/*
+ * Size of the chunks the writer thread takes off the queue, and the
+ * capacity we ask for the queue (pipe) between the capture loop and the
+ * writer thread.  A read that returns a full chunk means that at least
+ * that much data was waiting, i.e. the compressor is behind the capture.
+ */
+#define RINGBUF_WRITER_CHUNK        (64 * 1024)
+#define RINGBUF_WRITER_QUEUE_SIZE   (4 * 1024 * 1024)
+
+/* zstd compression level; favor speed, this runs at capture rate */
+#define RINGBUF_ZSTD_LEVEL          1
+
+/* Compression applied to each file as it is written */
+typedef enum {
+    RB_STREAM_NONE,
+    RB_STREAM_LZ4,
+    RB_STREAM_ZSTD
+} rb_stream_compression;
+
+/* Writer thread compressing the current ringbuffer file */
+typedef struct _rb_writer {
+    GThread      *thread;
+    int           queue_fd;            /**< Read end of the queue from the capture loop */
+    int           file_fd;             /**< The (compressed) ringbuffer file */
+    int           err;                 /**< First error, 0 if none */
+    GMutex        sync_mutex;
+    GCond         sync_cond;
+    int           next_queue_fd;       /**< Queue to continue with after a sync, -1 if none */
+    unsigned      syncs_requested;
+    unsigned      syncs_done;
+    bool          finished;            /**< The thread has stopped reading the queue */
+    uint8_t      *outbuf;
+    size_t        outbuf_size;
+#ifdef HAVE_ZSTD
+    ZSTD_CStream *zstd_cs;
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    LZ4F_cctx    *lz4_cctx;
+#endif
+} rb_writer;
+
 /* Ringbuffer file structure */
 typedef struct _rb_file {
     char          *name;
@@ -90,9 +139,14 @@ typedef struct _ringbuf_data {
     bool          group_read_access;   /**< true if files need to be opened with group read access */
     FILE         *name_h;              /**< write names of completed files to this handle */
     char         *compress_type;       /**< compress type */
+    rb_stream_compression stream_compression; /**< compression done while writing */
+    rb_writer    *writer;              /**< writer thread for the current file, if compressing */
 
     GMutex        mutex;               /**< mutex for oldnames */
     char         *oldnames[MAX_FILENAME_QUEUE];       /**< filename list of pending to be deleted */
+
+    GMutex        stats_mutex;         /**< mutex for writer_stats */
+    ringbuf_writer_stats writer_stats; /**< writer thread statistics, for all files */
 } ringbuf_data;
 
 static ringbuf_data rb_data;
@@ -216,6 +270,460 @@ ringbuf_start_compress_file(rb_file* rfile)
 }
 #endif
 
+/*
+ * Write all of a buffer to the file, retrying on short writes.
+ */
+static bool
+ringbuf_writer_write(rb_writer *writer, const uint8_t *data, size_t len)
+{
+    ssize_t nwritten;
+
+    while (len > 0) {
+        nwritten = ws_write(writer->file_fd, data, (unsigned int)len);
+        if (nwritten < 0) {
+            writer->err = errno;
+            return false;
+        }
+        data += nwritten;
+        len -= (size_t)nwritten;
+        g_mutex_lock(&rb_data.stats_mutex);
+        rb_data.writer_stats.bytes_out += nwritten;
+        g_mutex_unlock(&rb_data.stats_mutex);
+    }
+    return true;
+}
+
+/*
+ * Start a compressed stream in the current file.
+ */
+static bool
+ringbuf_writer_begin(rb_writer *writer)
+{
+    switch (rb_data.stream_compression) {
+
+#ifdef HAVE_ZSTD
+    case RB_STREAM_ZSTD:
+        writer->zstd_cs = ZSTD_createCStream();
+        if (writer->zstd_cs == NULL ||
+            ZSTD_isError(ZSTD_initCStream(writer->zstd_cs, RINGBUF_ZSTD_LEVEL))) {
+            writer->err = ENOMEM;
+            return false;
+        }
+        writer->outbuf_size = ZSTD_CStreamOutSize();
+        writer->outbuf = (uint8_t *)g_malloc(writer->outbuf_size);
+        return true;
+#endif
+
+#ifdef HAVE_LZ4FRAME_H
+    case RB_STREAM_LZ4:
+    {
+        size_t n;
+
+        if (LZ4F_isError(LZ4F_createCompressionContext(&writer->lz4_cctx, LZ4F_VERSION))) {
+            writer->err = ENOMEM;
+            return false;
+        }
+        /* Large enough for the frame header, any chunk, and the end mark. */
+        writer->outbuf_size = LZ4F_compressBound(RINGBUF_WRITER_CHUNK, NULL) + LZ4F_HEADER_SIZE_MAX;
+        writer->outbuf = (uint8_t *)g_malloc(writer->outbuf_size);
+        n = LZ4F_compressBegin(writer->lz4_cctx, writer->outbuf, writer->outbuf_size, NULL);
+        if (LZ4F_isError(n)) {
+            writer->err = EIO;
+            return false;
+        }
+        return ringbuf_writer_write(writer, writer->outbuf, n);
+    }
+#endif
+
+    default:
+        writer->err = EINVAL;
+        return false;
+    }
+}
+
+/*
+ * Compress a chunk taken off the queue. If the queue has run dry, also
+ * flush the compressor, so that the file is readable up to this point
+ * while the capture is idle, without paying for a flush on every chunk
+ * when the capture is busy.
+ */
+static bool
+ringbuf_writer_compress(rb_writer *writer, const uint8_t *data, size_t len, bool flush)
+{
+    switch (rb_data.stream_compression) {
+
+#ifdef HAVE_ZSTD
+    case RB_STREAM_ZSTD:
+    {
+        ZSTD_inBuffer input = { data, len, 0 };
+        ZSTD_outBuffer output;
+        size_t remaining;
+
+        while (input.pos < input.size) {
+            output.dst = writer->outbuf;
+            output.size = writer->outbuf_size;
+            output.pos = 0;
+            if (ZSTD_isError(ZSTD_compressStream(writer->zstd_cs, &output, &input))) {
+                writer->err = EIO;
+                return false;
+            }
+            if (!ringbuf_writer_write(writer, writer->outbuf, output.pos)) {
+                return false;
+            }
+        }
+        if (flush) {
+            do {
+                output.dst = writer->outbuf;
+                output.size = writer->outbuf_size;
+                output.pos = 0;
+                remaining = ZSTD_flushStream(writer->zstd_cs, &output);
+                if (ZSTD_isError(remaining)) {
+                    writer->err = EIO;
+                    return false;
+                }
+                if (!ringbuf_writer_write(writer, writer->outbuf, output.pos)) {
+                    return false;
+                }
+            } while (remaining > 0);
+        }
+        return true;
+    }
+#endif
+
+#ifdef HAVE_LZ4FRAME_H
+    case RB_STREAM_LZ4:
+    {
+        size_t n;
+
+        if (len > 0) {
+            n = LZ4F_compressUpdate(writer->lz4_cctx, writer->outbuf, writer->outbuf_size, data, len, NULL);
+            if (LZ4F_isError(n)) {
+                writer->err = EIO;
+                return false;
+            }
+            if (!ringbuf_writer_write(writer, writer->outbuf, n)) {
+                return false;
+            }
+        }
+        if (flush) {
+            n = LZ4F_flush(writer->lz4_cctx, writer->outbuf, writer->outbuf_size, NULL);
+            if (LZ4F_isError(n)) {
+                writer->err = EIO;
+                return false;
+            }
+            return ringbuf_writer_write(writer, writer->outbuf, n);
+        }
+        return true;
+    }
+#endif
+
+    default:
+        (void)data;
+        (void)len;
+        (void)flush;
+        writer->err = EINVAL;
+        return false;
+    }
+}
+
+/*
+ * Finish the compressed stream and free the compressor.
+ */
+static void
+ringbuf_writer_end(rb_writer *writer, bool ok)
+{
+#ifdef HAVE_ZSTD
+    if (writer->zstd_cs != NULL) {
+        ZSTD_outBuffer output;
+        size_t remaining;
+
+        while (ok) {
+            output.dst = writer->outbuf;
+            output.size = writer->outbuf_size;
+            output.pos = 0;
+            remaining = ZSTD_endStream(writer->zstd_cs, &output);
+            if (ZSTD_isError(remaining)) {
+                writer->err = EIO;
+                break;
+            }
+            if (!ringbuf_writer_write(writer, writer->outbuf, output.pos) || remaining == 0) {
+                break;
+            }
+        }
+        ZSTD_freeCStream(writer->zstd_cs);
+        writer->zstd_cs = NULL;
+    }
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    if (writer->lz4_cctx != NULL) {
+        if (ok) {
+            size_t n = LZ4F_compressEnd(writer->lz4_cctx, writer->outbuf, writer->outbuf_size, NULL);
+            if (LZ4F_isError(n)) {
+                writer->err = EIO;
+            } else {
+                ringbuf_writer_write(writer, writer->outbuf, n);
+            }
+        }
+        LZ4F_freeCompressionContext(writer->lz4_cctx);
+        writer->lz4_cctx = NULL;
+    }
+#endif
+    (void)ok;
+    g_free(writer->outbuf);
+    writer->outbuf = NULL;
+}
+
+/*
+ * Thread compressing the current ringbuffer file as the capture loop
+ * writes it. Runs until the capture loop closes its end of the queue.
+ *
+ * The capture loop syncs the file by handing us a new queue and closing
+ * its end of the current one (see ringbuf_sync()); at the end of the
+ * current queue we then flush the compressor and carry on with the new
+ * queue.
+ */
+static void*
+ringbuf_writer_thread(void* arg)
+{
+    rb_writer *writer = (rb_writer *)arg;
+    uint8_t *chunk;
+    ssize_t nread;
+    int next_queue_fd;
+    unsigned sync;
+    bool ok;
+
+    chunk = (uint8_t *)g_malloc(RINGBUF_WRITER_CHUNK);
+    ok = ringbuf_writer_begin(writer);
+    for (;;) {
+        while ((nread = ws_read(writer->queue_fd, chunk, RINGBUF_WRITER_CHUNK)) > 0) {
+            g_mutex_lock(&rb_data.stats_mutex);
+            rb_data.writer_stats.reads++;
+            rb_data.writer_stats.bytes_in += nread;
+            if (nread == RINGBUF_WRITER_CHUNK) {
+                rb_data.writer_stats.backlogged_reads++;
+            }
+            g_mutex_unlock(&rb_data.stats_mutex);
+
+            /* After an error keep draining the queue, so that the capture
+               loop doesn't block; the error is reported when the file is
+               closed. */
+            if (ok) {
+                ok = ringbuf_writer_compress(writer, chunk, nread, nread < RINGBUF_WRITER_CHUNK);
+            }
+        }
+        if (nread < 0) {
+            if (writer->err == 0) {
+                writer->err = errno;
+            }
+            ok = false;
+            break;
+        }
+
+        g_mutex_lock(&writer->sync_mutex);
+        next_queue_fd = writer->next_queue_fd;
+        writer->next_queue_fd = -1;
+        sync = writer->syncs_requested;
+        g_mutex_unlock(&writer->sync_mutex);
+        if (next_queue_fd == -1) {
+            /* The file is being closed */
+            break;
+        }
+
+        if (ok) {
+            ok = ringbuf_writer_compress(writer, NULL, 0, true);
+        }
+        ws_close(writer->queue_fd);
+        writer->queue_fd = next_queue_fd;
+
+        g_mutex_lock(&writer->sync_mutex);
+        writer->syncs_done = sync;
+        g_cond_signal(&writer->sync_cond);
+        g_mutex_unlock(&writer->sync_mutex);
+    }
+    ringbuf_writer_end(writer, ok);
+    g_free(chunk);
+
+    ws_close(writer->queue_fd);
+    if (ws_close(writer->file_fd) < 0 && writer->err == 0) {
+        writer->err = errno;
+    }
+
+    /* Don't leave the capture loop waiting for a sync we'll never do */
+    g_mutex_lock(&writer->sync_mutex);
+    if (writer->next_queue_fd != -1) {
+        ws_close(writer->next_queue_fd);
+        writer->next_queue_fd = -1;
+    }
+    writer->finished = true;
+    g_cond_signal(&writer->sync_cond);
+    g_mutex_unlock(&writer->sync_mutex);
+    return NULL;
+}
+
+/*
+ * Create a queue between the capture loop and the writer thread.
+ */
+static bool
+ringbuf_writer_queue(int queue_fds[2], int *err)
+{
+#ifdef _WIN32
+    if (_pipe(queue_fds, RINGBUF_WRITER_QUEUE_SIZE, O_BINARY) < 0) {
+#else
+    if (pipe(queue_fds) < 0) {
+#endif
+        if (err != NULL) {
+            *err = errno;
+        }
+        return false;
+    }
+#ifdef F_SETPIPE_SZ
+    /* Best effort; the default (64 KiB on Linux) still works, it just
+       absorbs less jitter in the compressor. */
+    (void) fcntl(queue_fds[1], F_SETPIPE_SZ, RINGBUF_WRITER_QUEUE_SIZE);
+#endif
+    return true;
+}
+
+/*
+ * Start a writer thread for the current ringbuffer file, and return the
+ * file descriptor the capture loop should write uncompressed data to.
+ */
+static int
+ringbuf_writer_start(int *err)
+{
+    rb_writer *writer;
+    int queue_fds[2];
+
+    if (!ringbuf_writer_queue(queue_fds, err)) {
+        return -1;
+    }
+
+    writer = g_new0(rb_writer, 1);
+    writer->queue_fd = queue_fds[0];
+    writer->file_fd = rb_data.fd;
+    g_mutex_init(&writer->sync_mutex);
+    g_cond_init(&writer->sync_cond);
+    writer->next_queue_fd = -1;
+    writer->thread = g_thread_new("ringbuf_writer", &ringbuf_writer_thread, writer);
+    rb_data.writer = writer;
+
+    return queue_fds[1];
+}
+
+/*
+ * Wait for the writer thread to drain the queue and finish the file.
+ * The capture loop's end of the queue must already be closed.
+ */
+static bool
+ringbuf_writer_finish(int *err)
+{
+    rb_writer *writer = rb_data.writer;
+    bool ret_val = true;
+
+    if (writer == NULL) {
+        return true;
+    }
+    g_thread_join(writer->thread);
+    if (writer->err != 0) {
+        if (err != NULL) {
+            *err = writer->err;
+        }
+        ret_val = false;
+    }
+    g_mutex_clear(&writer->sync_mutex);
+    g_cond_clear(&writer->sync_cond);
+    g_free(writer);
+    rb_data.writer = NULL;
+    return ret_val;
+}
+
+/*
+ * Wait for the writer thread to compress and write out everything the
+ * capture loop has written so far, so that a reader sees all of it.
+ *
+ * There's no way to tell from the queue alone when the thread has taken
+ * everything off it, so end the queue instead: hand the thread a new
+ * one, and make the stream's descriptor refer to it, which closes our
+ * end of the current one. The thread flushes the compressor when it
+ * reaches the end of the current queue.
+ */
+static bool
+ringbuf_writer_sync(int *err)
+{
+    rb_writer *writer = rb_data.writer;
+    int queue_fds[2];
+    unsigned sync;
+
+    if (!ringbuf_writer_queue(queue_fds, err)) {
+        return false;
+    }
+
+    g_mutex_lock(&writer->sync_mutex);
+    if (writer->finished) {
+        /* It stopped on an error, which is reported when the file is closed */
+        g_mutex_unlock(&writer->sync_mutex);
+        ws_close(queue_fds[0]);
+        ws_close(queue_fds[1]);
+        return true;
+    }
+    writer->next_queue_fd = queue_fds[0];
+    sync = ++writer->syncs_requested;
+    g_mutex_unlock(&writer->sync_mutex);
+
+    if (ws_dup2(queue_fds[1], ws_fileno(rb_data.pdh)) < 0) {
+        if (err != NULL) {
+            *err = errno;
+        }
+        g_mutex_lock(&writer->sync_mutex);
+        if (writer->next_queue_fd == queue_fds[0]) {
+            ws_close(queue_fds[0]);
+            writer->next_queue_fd = -1;
+        }
+        writer->syncs_requested--;
+        g_mutex_unlock(&writer->sync_mutex);
+        ws_close(queue_fds[1]);
+        return false;
+    }
+    ws_close(queue_fds[1]);
+
+    g_mutex_lock(&writer->sync_mutex);
+    while (writer->syncs_done != sync && !writer->finished) {
+        g_cond_wait(&writer->sync_cond, &writer->sync_mutex);
+    }
+    g_mutex_unlock(&writer->sync_mutex);
+
+    return true;
+}
+
+/*
+ * Close the stream for the current file. If the file is compressed as
+ * it is written, this also waits for the writer thread to finish it, and
+ * the writer thread closes the file itself.
+ */
+static bool
+ringbuf_close_pdh(int *err)
+{
+    bool ret_val = true;
+
+    if (fclose(rb_data.pdh) == EOF) {
+        if (err != NULL) {
+            *err = errno;
+        }
+        if (rb_data.writer == NULL) {
+            ws_close(rb_data.fd);  /* XXX - the above should have closed this already */
+        }
+        ret_val = false;
+    }
+    rb_data.pdh = NULL;    /* it's closed even if we got an error while closing */
+
+    if (!ringbuf_writer_finish(ret_val ? err : NULL)) {
+        ret_val = false;
+    }
+    rb_data.fd = -1;
+
+    return ret_val;
+}
+
 /*
  * create the next filename and open a new binary file with that name
  */
@@ -283,6 +791,8 @@ ringbuf_init(const char *capfile_name, unsigned num_files, bool group_read_acces
     unsigned int i;
     char        *pfx;
     char        *dir_name, *base_name;
+    const char  *compress_ext = NULL;
+    bool         stripped_ext = false;
 
     rb_data.files = NULL;
     rb_data.curr_file_num = 0;
@@ -296,7 +806,26 @@ ringbuf_init(const char *capfile_name, unsigned num_files, bool group_read_acces
     rb_data.group_read_access = group_read_access;
     rb_data.name_h = NULL;
     rb_data.compress_type = compress_type;
+    rb_data.stream_compression = RB_STREAM_NONE;
+    rb_data.writer = NULL;
     g_mutex_init(&rb_data.mutex);
+    g_mutex_init(&rb_data.stats_mutex);
+    memset(&rb_data.writer_stats, 0, sizeof(rb_data.writer_stats));
+
+    if (compress_type != NULL) {
+#ifdef HAVE_ZSTD
+        if (strcmp(compress_type, "zstd") == 0) {
+            rb_data.stream_compression = RB_STREAM_ZSTD;
+            compress_ext = ".zst";
+        }
+#endif
+#ifdef HAVE_LZ4FRAME_H
+        if (strcmp(compress_type, "lz4") == 0) {
+            rb_data.stream_compression = RB_STREAM_LZ4;
+            compress_ext = ".lz4";
+        }
+#endif
+    }
 
     /* just to be sure ... */
     if (num_files <= RINGBUFFER_MAX_NUM_FILES) {
@@ -315,6 +844,13 @@ ringbuf_init(const char *capfile_name, unsigned num_files, bool group_read_acces
 
     base_name = g_path_get_basename(capfile_name);
     dir_name = g_path_get_dirname(capfile_name);
+    if (compress_ext != NULL && g_str_has_suffix(base_name, compress_ext) &&
+        strlen(base_name) > strlen(compress_ext)) {
+        /* The name already has the compression suffix; it's appended
+           after the ring buffer file's own suffix below. */
+        base_name[strlen(base_name) - strlen(compress_ext)] = '\0';
+        stripped_ext = true;
+    }
     pfx = strrchr(base_name, '.');
     if (pfx != NULL) {
         /* The basename has a "." in it.
@@ -322,19 +858,19 @@ ringbuf_init(const char *capfile_name, unsigned num_files, bool group_read_acces
            Treat it as a separator between the rest of the file name and
            the file name suffix, and arrange that the names given to the
            ring buffer files have the specified suffix, i.e. put the
-           changing part of the name *before* the suffix.
-
-           XXX - If we ever handle writing compressed files directly
-           (#19159) make sure we deal with any compression suffix
-           appropriately. */
+           changing part of the name *before* the suffix. */
         pfx[0] = '\0';
         rb_data.fprefix = g_build_filename(dir_name, base_name, NULL);
         pfx[0] = '.'; /* restore capfile_name */
-        rb_data.fsuffix = g_strdup(pfx);
+        rb_data.fsuffix = g_strconcat(pfx, compress_ext, NULL);
     } else {
         /* The last component has no suffix. */
-        rb_data.fprefix = g_strdup(capfile_name);
-        rb_data.fsuffix = NULL;
+        if (stripped_ext) {
+            rb_data.fprefix = g_build_filename(dir_name, base_name, NULL);
+        } else {
+            rb_data.fprefix = g_strdup(capfile_name);
+        }
+        rb_data.fsuffix = g_strdup(compress_ext);
     }
     g_free(dir_name);
     g_free(base_name);
@@ -410,17 +946,48 @@ ringbuf_current_filename(void)
     return rb_data.files[rb_data.curr_file_num % rb_data.num_files].name;
 }
 
+/*
+ * Get the statistics of the thread compressing ringbuffer files as
+ * they are written. Returns false if files aren't compressed that way.
+ */
+bool
+ringbuf_get_writer_stats(ringbuf_writer_stats *stats)
+{
+    if (rb_data.stream_compression == RB_STREAM_NONE) {
+        return false;
+    }
+    g_mutex_lock(&rb_data.stats_mutex);
+    *stats = rb_data.writer_stats;
+    g_mutex_unlock(&rb_data.stats_mutex);
+    return true;
+}
+
 /*
  * Calls ws_fdopen() for the current ringbuffer file
  */
 FILE *
 ringbuf_init_libpcap_fdopen(int *err)
 {
-    rb_data.pdh = ws_fdopen(rb_data.fd, "wb");
+    int fd = rb_data.fd;
+
+    if (rb_data.stream_compression != RB_STREAM_NONE) {
+        /* Write to the queue of a thread compressing the file instead */
+        fd = ringbuf_writer_start(err);
+        if (fd == -1) {
+            return NULL;
+        }
+    }
+
+    rb_data.pdh = ws_fdopen(fd, "wb");
     if (rb_data.pdh == NULL) {
         if (err != NULL) {
             *err = errno;
         }
+        if (rb_data.writer != NULL) {
+            ws_close(fd);
+            ringbuf_writer_finish(NULL);
+            rb_data.fd = -1;
+        }
     } else {
         size_t buffsize = IO_BUF_SIZE;
 #ifdef HAVE_STRUCT_STAT_ST_BLKSIZE
@@ -440,6 +1007,29 @@ ringbuf_init_libpcap_fdopen(int *err)
     return rb_data.pdh;
 }
 
+/*
+ * Write out everything written to the current file so far, including,
+ * if the file is compressed as it is written, waiting for the writer
+ * thread to compress it. Call this before telling anyone to read it.
+ */
+bool
+ringbuf_sync(int *err)
+{
+    if (rb_data.pdh == NULL) {
+        return true;
+    }
+    if (fflush(rb_data.pdh) == EOF) {
+        if (err != NULL) {
+            *err = errno;
+        }
+        return false;
+    }
+    if (rb_data.writer == NULL) {
+        return true;
+    }
+    return ringbuf_writer_sync(err);
+}
+
 /*
  * Switches to the next ringbuffer file
  */
@@ -451,21 +1041,12 @@ ringbuf_switch_file(FILE **pdh, char **save_file, int *save_file_fd, int *err)
 
     /* close current file */
 
-    if (fclose(rb_data.pdh) == EOF) {
-        if (err != NULL) {
-            *err = errno;
-        }
-        ws_close(rb_data.fd);  /* XXX - the above should have closed this already */
-        rb_data.pdh = NULL;    /* it's still closed, we just got an error while closing */
-        rb_data.fd = -1;
+    if (!ringbuf_close_pdh(err)) {
         g_free(rb_data.io_buffer);
         rb_data.io_buffer = NULL;
         return false;
     }
 
-    rb_data.pdh = NULL;
-    rb_data.fd  = -1;
-
     if (rb_data.name_h != NULL) {
         fprintf(rb_data.name_h, "%s\n", ringbuf_current_filename());
         fflush(rb_data.name_h);
@@ -503,15 +1084,7 @@ ringbuf_libpcap_dump_close(char **save_file, int *err)
 
     /* close current file, if it's open */
     if (rb_data.pdh != NULL) {
-        if (fclose(rb_data.pdh) == EOF) {
-            if (err != NULL) {
-                *err = errno;
-            }
-            ws_close(rb_data.fd);
-            ret_val = false;
-        }
-        rb_data.pdh = NULL;
-        rb_data.fd  = -1;
+        ret_val = ringbuf_close_pdh(err);
         g_free(rb_data.io_buffer);
         rb_data.io_buffer = NULL;
 
@@ -577,6 +1150,12 @@ ringbuf_error_cleanup(void)
         rb_data.pdh = NULL;
     }
 
+    /* the writer thread closes the file itself */
+    if (rb_data.writer != NULL) {
+        ringbuf_writer_finish(NULL);
+        rb_data.fd = -1;
+    }
+
     /* close directly if still open */
     if (rb_data.fd != -1) {
         ws_close(rb_data.fd);
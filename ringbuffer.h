@@ -24,16 +24,26 @@
 /* Maximum number for FAT filesystems */
 #define RINGBUFFER_WARN_NUM_FILES 65535
 
+/** Statistics of the thread compressing ringbuffer files as they are written */
+typedef struct {
+    uint64_t bytes_in;          /**< Uncompressed bytes taken off the queue */
+    uint64_t bytes_out;         /**< Compressed bytes written to disk */
+    uint64_t reads;             /**< Chunks taken off the queue */
+    uint64_t backlogged_reads;  /**< Chunks taken off a backlogged queue, i.e. the compressor was behind */
+} ringbuf_writer_stats;
+
 int ringbuf_init(const char *capture_name, unsigned num_files, bool group_read_access, char* compress_type,
                  bool nametimenum);
 bool ringbuf_is_initialized(void);
 const char *ringbuf_current_filename(void);
 FILE *ringbuf_init_libpcap_fdopen(int *err);
+bool ringbuf_sync(int *err);
 bool ringbuf_switch_file(FILE **pdh, char **save_file, int *save_file_fd,
                              int *err);
 bool ringbuf_libpcap_dump_close(char **save_file, int *err);
 void ringbuf_free(void);
 void ringbuf_error_cleanup(void);
 bool ringbuf_set_print_name(char *name, int *err);
+bool ringbuf_get_writer_stats(ringbuf_writer_stats *stats);
 
 #endif /* ringbuffer.h */
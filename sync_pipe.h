@@ -49,6 +49,7 @@
 #define SP_SUCCESS      'S'     /* success indication, no extra data */
 #define SP_TOOLBAR_CTRL 'T'     /* interface toolbar control packet */
 #define SP_IFACE_LIST   'I'     /* interface list */
+#define SP_WRITER_STATS 'W'     /* statistics of the ring buffer compression thread */
 /*
  * Win32 only: Indications sent out on the signal pipe (from parent to child)
  * (UNIX-like sends signals for this)
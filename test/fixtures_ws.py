@@ -109,6 +109,11 @@ def cmd_mergecap(program):
     return program('mergecap')
 
 
+@pytest.fixture(scope='session')
+def cmd_reordercap(program):
+    return program('reordercap')
+
+
 @pytest.fixture(scope='session')
 def cmd_rawshark(program):
     return program('rawshark')
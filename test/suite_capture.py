@@ -178,6 +178,30 @@ def check_capture_stdin(cmd_capinfos, result_file):
     return check_capture_stdin_real
 
 
+@pytest.fixture
+def check_capture_shm_ring(cmd_tshark):
+    # Dumpcap writes into a shared memory ring that TShark reads from
+    # instead of a temporary file.
+    def check_capture_shm_ring_real(self, env=None):
+        if sys.platform.startswith('win32') or not os.path.isdir('/dev/shm'):
+            pytest.skip('Shared memory rings are only checked on systems with /dev/shm')
+        shm_before = set(glob.glob('/dev/shm/wireshark_*'))
+        slow_dhcp_cmd = cat_dhcp_command('slow')
+        capture_cmd = capture_command(cmd_tshark,
+            '--shm-ring',
+            '-i', '-',
+            '-a', 'duration:{}'.format(capture_duration),
+            shell=True
+        )
+        pipe_proc = subprocesstest.run(slow_dhcp_cmd + ' | ' + capture_cmd, shell=True, capture_output=True, env=env)
+        if 'isn\'t supported on this platform' in pipe_proc.stderr:
+            pytest.skip('Shared memory rings are not supported on this platform')
+        assert pipe_proc.returncode == 0
+        assert count_output(pipe_proc.stdout, 'DHCP') == 8
+        # The reader unlinks the ring once it has opened it.
+        assert set(glob.glob('/dev/shm/wireshark_*')) <= shm_before
+    return check_capture_shm_ring_real
+
 @pytest.fixture
 def check_capture_read_filter(capture_interface, traffic_generator, cmd_capinfos, result_file):
     start_traffic, cfilter = traffic_generator
@@ -304,6 +328,45 @@ def check_dumpcap_ringbuffer_stdin(cmd_dumpcap, cmd_capinfos, result_file):
     return check_dumpcap_ringbuffer_stdin_real
 
 
+@pytest.fixture
+def check_ringbuffer_compressed_stdin(cmd_capinfos, result_file):
+    def check_ringbuffer_compressed_stdin_real(self, cmd=None, compress_type=None, print_packets=False, env=None):
+        # Similar to check_dumpcap_ringbuffer_stdin, but with files that are
+        # compressed as they are written. With TShark, Dumpcap runs as a
+        # child and TShark reads each file while it is being written; the
+        # slow dump makes it read the first one before it's finished.
+        assert cmd is not None
+        rb_unique = 'dhcp_rb_' + uuid.uuid4().hex[:6] # Random ID
+        testout_file = result_file('testout.{}.pcapng'.format(rb_unique))
+        testout_glob = result_file('testout.{}_*.pcapng.{}'.format(rb_unique, 'zst' if compress_type == 'zstd' else compress_type))
+        slow_dhcp_cmd = cat_dhcp_command('slow')
+        capture_cmd = capture_command(cmd,
+            '-i', '-',
+            '-w', f'"{testout_file}"',
+            '-a', 'files:2',
+            '-b', 'packets:4',
+            '--compress-type', compress_type,
+            shell=True
+        )
+        if print_packets:
+            capture_cmd += ' -P'
+        if sysconfig.get_platform().startswith('mingw'):
+            pytest.skip('FIXME Pipes are broken with the MSYS2 shell')
+        pipe_proc = subprocesstest.run(slow_dhcp_cmd + ' | ' + capture_cmd, shell=True, capture_output=True, env=env)
+        if "compression is not supported" in pipe_proc.stderr:
+            pytest.skip('Requires {} support'.format(compress_type))
+        assert pipe_proc.returncode == 0, pipe_proc.stderr
+        if print_packets:
+            assert count_output(pipe_proc.stdout) == 8
+
+        rb_files = glob.glob(testout_glob)
+        assert len(rb_files) == 2
+
+        for rbf in rb_files:
+            check_packet_count(cmd_capinfos, 4, rbf)
+    return check_ringbuffer_compressed_stdin_real
+
+
 @pytest.fixture
 def check_dumpcap_pcapng_sections(cmd_dumpcap, cmd_tshark, cmd_capinfos, capture_file, result_file):
     if sys.platform == 'win32':
@@ -529,6 +592,10 @@ class TestTsharkCapture:
         '''Capture truncated packets using TShark'''
         check_capture_snapshot_len(self, cmd=cmd_tshark, env=test_env)
 
+    def test_tshark_capture_shm_ring(self, check_capture_shm_ring, test_env):
+        '''Capture from stdin using TShark, getting packets from dumpcap through shared memory'''
+        check_capture_shm_ring(self, env=test_env)
+
 
 class TestDumpcapCapture:
     def test_dumpcap_capture_10_packets_to_file(self, cmd_dumpcap, check_capture_10_packets, base_env):
@@ -573,6 +640,22 @@ class TestDumpcapRingbuffer:
         '''Capture from stdin using Dumpcap and write multiple files until we reach a packet limit'''
         check_dumpcap_ringbuffer_stdin(self, packets=47, env=base_env) # Last prime before 50. Arbitrary.
 
+    def test_dumpcap_ringbuffer_zstd(self, cmd_dumpcap, check_ringbuffer_compressed_stdin, base_env):
+        '''Capture from stdin using Dumpcap and write multiple zstd-compressed files'''
+        check_ringbuffer_compressed_stdin(self, cmd=cmd_dumpcap, compress_type='zstd', env=base_env)
+
+    def test_dumpcap_ringbuffer_lz4(self, cmd_dumpcap, check_ringbuffer_compressed_stdin, base_env):
+        '''Capture from stdin using Dumpcap and write multiple LZ4-compressed files'''
+        check_ringbuffer_compressed_stdin(self, cmd=cmd_dumpcap, compress_type='lz4', env=base_env)
+
+    def test_tshark_ringbuffer_zstd(self, cmd_tshark, check_ringbuffer_compressed_stdin, test_env):
+        '''Capture from stdin using TShark, reading zstd-compressed files while Dumpcap writes them'''
+        check_ringbuffer_compressed_stdin(self, cmd=cmd_tshark, compress_type='zstd', print_packets=True, env=test_env)
+
+    def test_tshark_ringbuffer_lz4(self, cmd_tshark, check_ringbuffer_compressed_stdin, test_env):
+        '''Capture from stdin using TShark, reading LZ4-compressed files while Dumpcap writes them'''
+        check_ringbuffer_compressed_stdin(self, cmd=cmd_tshark, compress_type='lz4', print_packets=True, env=test_env)
+
 
 class TestDumpcapPcapngSections:
     def test_dumpcap_pcapng_single_in_single_out(self, check_dumpcap_pcapng_sections, base_env):
@@ -104,3 +104,19 @@ class TestNameResolution:
                 ), encoding='utf-8')
         assert '174.137.42.65\twww.wireshark.org' not in stdout
         assert 'fe80::6233:4bff:fe13:c558\tCrunch.local' in stdout
+
+    def test_subnets_ipv6(self, cmd_tshark, capture_file, conf_path, test_env):
+        '''IPv6 addresses named after the subnet they are in.'''
+        # ipv6.pcap has one packet from fe80::200:86ff:fe05:80fa to ff05::9999.
+        with open(os.path.join(conf_path, 'subnets'), 'w') as subnets_file:
+            subnets_file.write('fe80::/64\tlinklocal\n')
+            # Clearing the first 4 bits of ff05::9999 leaves f05::9999.
+            subnets_file.write('ff00::/4\tmcast\n')
+        stdout = subprocess.check_output((cmd_tshark,
+                '-r', capture_file('ipv6.pcap'),
+                '-N', 'n',
+                '-T', 'fields',
+                '-e', 'ipv6.src_host',
+                '-e', 'ipv6.dst_host',
+                ), encoding='utf-8', env=test_env)
+        assert stdout.strip() == 'linklocal::200:86ff:fe05:80fa\tmcast:f05::9999'
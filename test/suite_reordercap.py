@@ -0,0 +1,92 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Reordercap tests'''
+
+import random
+import struct
+import subprocess
+import pytest
+
+testin_pcap = 'testin.pcap'
+testout_pcap = 'testout.pcap'
+testout_mem_pcap = 'testout-mem.pcap'
+
+
+def write_pcap(path, timestamps):
+    '''Write a pcap file with one small Ethernet frame per timestamp. Each
+    frame carries its original position so the output order can be checked.'''
+    with open(path, 'wb') as f:
+        f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+        for num, (secs, usecs) in enumerate(timestamps):
+            frame = b'\xff' * 12 + b'\x88\xb5' + struct.pack('>I', num)
+            f.write(struct.pack('<IIII', secs, usecs, len(frame), len(frame)))
+            f.write(frame)
+
+
+def read_pcap(path):
+    '''Return (timestamp, original position) for each frame in a pcap file.'''
+    frames = []
+    with open(path, 'rb') as f:
+        data = f.read()
+    # Output files are written in the host byte order.
+    endian = '<' if data[:4] == b'\xd4\xc3\xb2\xa1' else '>'
+    pos = 24
+    while pos < len(data):
+        secs, usecs, caplen, _ = struct.unpack_from(endian + 'IIII', data, pos)
+        pos += 16
+        num, = struct.unpack_from('>I', data, pos + 14)
+        frames.append(((secs, usecs), num))
+        pos += caplen
+    return frames
+
+
+@pytest.fixture
+def out_of_order_pcap(result_file):
+    '''A capture whose frames are in random time order, with some ties.'''
+    rng = random.Random(4242)
+    timestamps = [(1700000000 + rng.randrange(50), rng.randrange(4) * 250000) for _ in range(500)]
+    testin_file = result_file(testin_pcap)
+    write_pcap(testin_file, timestamps)
+    return testin_file
+
+
+class TestReordercap:
+    def check_reordered(self, infile, outfile):
+        frames = read_pcap(outfile)
+        # Sorted by time, frames with equal times in their original order.
+        assert frames == sorted(read_pcap(infile))
+
+    def test_reordercap_in_memory(self, cmd_reordercap, out_of_order_pcap, result_file, test_env):
+        '''Reorder a capture with all frame records in memory'''
+        testout_file = result_file(testout_pcap)
+        subprocess.check_call((cmd_reordercap, out_of_order_pcap, testout_file), env=test_env)
+        self.check_reordered(out_of_order_pcap, testout_file)
+
+    @pytest.mark.parametrize('max_frames', ['1', '3', '64'])
+    def test_reordercap_external(self, cmd_reordercap, out_of_order_pcap, result_file, test_env, max_frames):
+        '''Reorder a capture through sorted runs on disk'''
+        # With -m 1 or -m 3 there are far more runs than are merged at
+        # once, so this also covers merging in several passes.
+        testout_file = result_file(testout_pcap)
+        testout_mem_file = result_file(testout_mem_pcap)
+        subprocess.check_call((cmd_reordercap, '-m', max_frames, out_of_order_pcap, testout_file), env=test_env)
+        self.check_reordered(out_of_order_pcap, testout_file)
+        subprocess.check_call((cmd_reordercap, out_of_order_pcap, testout_mem_file), env=test_env)
+        with open(testout_file, 'rb') as f1, open(testout_mem_file, 'rb') as f2:
+            assert f1.read() == f2.read()
+
+    def test_reordercap_external_nearly_sorted(self, cmd_reordercap, result_file, test_env):
+        '''Reorder a capture whose frames are only slightly out of order'''
+        rng = random.Random(17)
+        timestamps = [(1700000000 + i * 10 + rng.randrange(40), 0) for i in range(300)]
+        testin_file = result_file(testin_pcap)
+        testout_file = result_file(testout_pcap)
+        write_pcap(testin_file, timestamps)
+        proc = subprocess.run((cmd_reordercap, '-m', '8', testin_file, testout_file),
+            capture_output=True, encoding='utf-8', env=test_env)
+        assert proc.returncode == 0
+        assert '300 frames' in proc.stdout
+        self.check_reordered(testin_file, testout_file)
@@ -117,6 +117,7 @@
 #include <wsutil/str_util.h>
 #include <wsutil/utf8_entities.h>
 #include <wsutil/json_dumper.h>
+#include <wsutil/shm_ring.h>
 #include <wsutil/wslog.h>
 #ifdef _WIN32
 #include <wsutil/win32-utils.h>
@@ -145,6 +146,7 @@
 #define LONGOPT_PRINT_TIMERS            LONGOPT_BASE_APPLICATION+9
 #define LONGOPT_GLOBAL_PROFILE          LONGOPT_BASE_APPLICATION+10
 #define LONGOPT_COMPRESS                LONGOPT_BASE_APPLICATION+11
+#define LONGOPT_SHM_RING                LONGOPT_BASE_APPLICATION+12
 
 capture_file cfile;
 
@@ -481,6 +483,8 @@ print_usage(FILE *output)
     fprintf(output, "                                          an exact multiple of NUM secs\n");
     fprintf(output, "                         printname:FILE - print filename to FILE when written\n");
     fprintf(output, "                                          (can use 'stdout' or 'stderr')\n");
+    fprintf(output, "  --shm-ring               if not saving to a file, get packets from dumpcap\n");
+    fprintf(output, "                           through shared memory instead of a temporary file\n");
 #endif  /* HAVE_LIBPCAP */
 #ifdef HAVE_PCAP_REMOTE
     fprintf(output, "RPCAP options:\n");
@@ -981,6 +985,9 @@ main(int argc, char *argv[])
         {"print-timers", ws_no_argument, NULL, LONGOPT_PRINT_TIMERS},
         {"global-profile", ws_no_argument, NULL, LONGOPT_GLOBAL_PROFILE},
         {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+#ifdef HAVE_LIBPCAP
+        {"shm-ring", ws_no_argument, NULL, LONGOPT_SHM_RING},
+#endif
         {0, 0, 0, 0}
     };
     bool                 arg_error = false;
@@ -1938,6 +1945,16 @@ main(int argc, char *argv[])
                     goto clean_exit;
                 }
                 break;
+#ifdef HAVE_LIBPCAP
+            case LONGOPT_SHM_RING:
+                if (!shm_ring_is_supported()) {
+                    cmdarg_err("--shm-ring isn't supported on this platform");
+                    exit_status = WS_EXIT_INVALID_OPTION;
+                    goto clean_exit;
+                }
+                global_capture_opts.use_shm_ring = true;
+                break;
+#endif
             default:
             case '?':        /* Bad flag - print usage message */
                 switch(ws_optopt) {
@@ -2795,6 +2812,12 @@ main(int argc, char *argv[])
             goto clean_exit;
         }
 
+        /* The shared memory ring only works if we read every packet as
+           dumpcap tells us about it, and there's no file to keep. */
+        if (!do_dissection || global_capture_opts.save_file != NULL) {
+            global_capture_opts.use_shm_ring = false;
+        }
+
         /* Write a preamble if we're printing one. Do this after all checking
          * for invalid options, so we don't print just a preamble and quit. */
         if (print_packet_info) {
@@ -3091,8 +3114,10 @@ capture_input_new_file(capture_session *cap_session, char *new_file)
         epan_free(cf->epan);
         cf->epan = tshark_epan_new(cf);
     } else {
-        /* we didn't had a save_file before, must be a tempfile */
-        is_tempfile = true;
+        /* we didn't had a save_file before, must be a tempfile, unless
+           it's a shared memory ring, which the reader unlinks as soon as
+           it maps it and which isn't a file we can remove */
+        is_tempfile = shm_ring_path_name(new_file) == NULL;
     }
 
     /* save the new filename */
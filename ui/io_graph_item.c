@@ -310,3 +310,88 @@ double get_io_graph_item(const io_graph_item_t *items_, io_graph_item_unit_t val
     }
     return value;
 }
+
+void merge_io_graph_item(io_graph_item_t *item, const io_graph_item_t *src, int hf_index)
+{
+    if (item->first_frame_in_invl == 0) {
+        item->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl != 0) {
+        item->last_frame_in_invl = src->last_frame_in_invl;
+    }
+
+    if (src->fields > 0 && hf_index >= 0) {
+        /* If fields == 0, this is the first set of values so take
+         * src's min/max values. Ties keep the earlier frame, as
+         * update_io_graph_item() does. */
+        bool first = (item->fields == 0);
+
+        switch (proto_registrar_get_ftype(hf_index)) {
+        case FT_UINT8:
+        case FT_UINT16:
+        case FT_UINT24:
+        case FT_UINT32:
+        case FT_UINT40:
+        case FT_UINT48:
+        case FT_UINT56:
+        case FT_UINT64:
+            if (first || src->uint_max > item->uint_max) {
+                item->uint_max = src->uint_max;
+                item->max_frame_in_invl = src->max_frame_in_invl;
+            }
+            if (first || src->uint_min < item->uint_min) {
+                item->uint_min = src->uint_min;
+                item->min_frame_in_invl = src->min_frame_in_invl;
+            }
+            item->double_tot += src->double_tot;
+            break;
+        case FT_INT8:
+        case FT_INT16:
+        case FT_INT24:
+        case FT_INT32:
+        case FT_INT40:
+        case FT_INT48:
+        case FT_INT56:
+        case FT_INT64:
+            if (first || src->int_max > item->int_max) {
+                item->int_max = src->int_max;
+                item->max_frame_in_invl = src->max_frame_in_invl;
+            }
+            if (first || src->int_min < item->int_min) {
+                item->int_min = src->int_min;
+                item->min_frame_in_invl = src->min_frame_in_invl;
+            }
+            item->double_tot += src->double_tot;
+            break;
+        case FT_FLOAT:
+        case FT_DOUBLE:
+            if (first || src->double_max > item->double_max) {
+                item->double_max = src->double_max;
+                item->max_frame_in_invl = src->max_frame_in_invl;
+            }
+            if (first || src->double_min < item->double_min) {
+                item->double_min = src->double_min;
+                item->min_frame_in_invl = src->min_frame_in_invl;
+            }
+            item->double_tot += src->double_tot;
+            break;
+        case FT_RELATIVE_TIME:
+            if (first || nstime_cmp(&src->time_max, &item->time_max) > 0) {
+                item->time_max = src->time_max;
+                item->max_frame_in_invl = src->max_frame_in_invl;
+            }
+            if (first || nstime_cmp(&src->time_min, &item->time_min) < 0) {
+                item->time_min = src->time_min;
+                item->min_frame_in_invl = src->min_frame_in_invl;
+            }
+            nstime_add(&item->time_tot, &src->time_tot);
+            break;
+        default:
+            break;
+        }
+    }
+
+    item->fields += src->fields;
+    item->frames += src->frames;
+    item->bytes += src->bytes;
+}
@@ -193,6 +193,18 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
  */
 double get_io_graph_item(const io_graph_item_t *items, io_graph_item_unit_t val_units, int idx, int hf_index, const capture_file *cap_file, int interval, int cur_idx, bool asAOT);
 
+/** Add the values of one io_graph_item_t to another.
+ *
+ * Used to sum items collected at a fine interval into items for a
+ * coarser interval that is a multiple of it. Items must be merged in
+ * time order.
+ *
+ * @param item [in,out] The item to add to.
+ * @param src [in] The item to add.
+ * @param hf_index [in] Header field index for advanced statistics.
+ */
+void merge_io_graph_item(io_graph_item_t *item, const io_graph_item_t *src, int hf_index);
+
 /** Update the values of an io_graph_item_t.
  *
  * Frame and byte counts are always calculated. If edt is non-NULL advanced
@@ -58,6 +58,16 @@
 // Matches SplashOverlay.
 static int info_update_freq_ = 100;
 
+// Far more than the text view can usefully show in either direction.
+const unsigned FollowStreamDialog::max_payload_bytes_ = 64 * 1024 * 1024;
+
+// Used to tap the stream again when saving it in raw form.
+typedef struct {
+    follow_info_t follow_info;  // must be first; this is the tap data
+    tap_packet_cb tap_handler;
+    QDataStream *out;
+} follow_save_info_t;
+
 // Handle the loop breaking notification properly
 static QMutex loop_break_mutex;
 
@@ -98,6 +108,9 @@ FollowStreamDialog::FollowStreamDialog(QWidget &parent, CaptureFile &cf, int pro
     memset(&follow_info_, 0, sizeof(follow_info_));
     follow_info_.show_stream = BOTH_HOSTS;
     follow_info_.substream_id = SUBSTREAM_UNUSED;
+    follow_info_.gui_data = this;
+    payload_bytes_[0] = payload_bytes_[1] = 0;
+    payload_truncated_[0] = payload_truncated_[1] = false;
 
     nstime_set_zero(&last_ts_);
 
@@ -331,7 +344,30 @@ void FollowStreamDialog::saveAs()
         return;
     }
 
-    // XXX: What if truncated_ is true? We should save the entire stream.
+    QDataStream out(&file);
+    if (recent.gui_follow_show == SHOW_RAW && (payload_truncated_[0] || payload_truncated_[1])) {
+        // We don't have the entire stream either; tap it again.
+        if (!saveRawStream(out)) {
+            file.remove();
+        }
+        return;
+    }
+    if (recent.gui_follow_show == SHOW_RAW && ui->teStreamContent->isTruncated()) {
+        // The displayed text doesn't hold the entire stream, but raw
+        // data can be written straight from the tapped payload.
+        for (GList *cur = g_list_last(follow_info_.payload); cur; cur = g_list_previous(cur)) {
+            follow_record_t *follow_record = (follow_record_t *)cur->data;
+            if ((follow_record->is_server && follow_info_.show_stream == FROM_CLIENT) ||
+                (!follow_record->is_server && follow_info_.show_stream == FROM_SERVER)) {
+                continue;
+            }
+            out.writeRawData((const char *)follow_record->data->data, static_cast<int>(follow_record->data->len));
+        }
+        return;
+    }
+
+    // XXX: What if truncated_ is true for the other formats? We should
+    // save the entire stream.
     // Unconditionally save data as UTF-8 (even if data is decoded otherwise).
     QByteArray bytes = ui->teStreamContent->toPlainText().toUtf8();
     if (recent.gui_follow_show == SHOW_RAW) {
@@ -341,7 +377,6 @@ void FollowStreamDialog::saveAs()
         bytes = QByteArray::fromHex(bytes);
     }
 
-    QDataStream out(&file);
     out.writeRawData(bytes.constData(), static_cast<int>(bytes.size()));
 }
 
@@ -553,7 +588,12 @@ void FollowStreamDialog::removeStreamControls()
 void FollowStreamDialog::resetStream(void *tap_data)
 {
     follow_info_t *follow_info = static_cast<follow_info_t*>(tap_data);
+    FollowStreamDialog *follow_dialog = static_cast<FollowStreamDialog*>(follow_info->gui_data);
     follow_reset_stream(follow_info);
+    if (follow_dialog) {
+        follow_dialog->payload_bytes_[0] = follow_dialog->payload_bytes_[1] = 0;
+        follow_dialog->payload_truncated_[0] = follow_dialog->payload_truncated_[1] = false;
+    }
     // If we ever draw the text while tapping (instead of only after
     // the tap finishes), reset the GUI here too.
 }
@@ -563,6 +603,91 @@ void FollowStreamDialog::resetStream()
     FollowStreamDialog::resetStream(&follow_info_);
 }
 
+// Tap the stream, keeping the payload of only the first max_payload_bytes_
+// in each direction. Later records are kept without their data, so that
+// the packet and turn counts stay right.
+tap_packet_status FollowStreamDialog::tapPacket(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data, tap_flags_t flags)
+{
+    follow_info_t *follow_info = static_cast<follow_info_t*>(tapdata);
+    FollowStreamDialog *follow_dialog = static_cast<FollowStreamDialog*>(follow_info->gui_data);
+    GList *prev_payload = follow_info->payload;
+    GList *cur, *oldest = NULL;
+
+    tap_packet_status status = get_follow_tap_handler(follow_dialog->follower_)(tapdata, pinfo, edt, data, flags);
+
+    // The handler prepends any new records.
+    for (cur = follow_info->payload; cur != prev_payload; cur = g_list_next(cur)) {
+        oldest = cur;
+    }
+    for (cur = oldest; cur; cur = (cur == follow_info->payload) ? NULL : g_list_previous(cur)) {
+        follow_record_t *follow_record = (follow_record_t *)cur->data;
+        int dir = follow_record->is_server ? 1 : 0;
+
+        if (!follow_dialog->payload_truncated_[dir] &&
+                follow_record->data->len <= max_payload_bytes_ - follow_dialog->payload_bytes_[dir]) {
+            follow_dialog->payload_bytes_[dir] += follow_record->data->len;
+        } else {
+            follow_dialog->payload_truncated_[dir] = true;
+            g_byte_array_free(follow_record->data, true);
+            follow_record->data = NULL;
+        }
+    }
+
+    return status;
+}
+
+// Tap the stream, writing the raw data of each record out as it comes
+// instead of keeping it.
+tap_packet_status FollowStreamDialog::saveRawPacket(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data, tap_flags_t flags)
+{
+    follow_save_info_t *save_info = static_cast<follow_save_info_t*>(tapdata);
+    follow_info_t *follow_info = &save_info->follow_info;
+
+    tap_packet_status status = save_info->tap_handler(tapdata, pinfo, edt, data, flags);
+
+    for (GList *cur = g_list_last(follow_info->payload); cur; cur = g_list_previous(cur)) {
+        follow_record_t *follow_record = (follow_record_t *)cur->data;
+        if (!((follow_record->is_server && follow_info->show_stream == FROM_CLIENT) ||
+              (!follow_record->is_server && follow_info->show_stream == FROM_SERVER))) {
+            save_info->out->writeRawData((const char *)follow_record->data->data, static_cast<int>(follow_record->data->len));
+        }
+        g_byte_array_free(follow_record->data, true);
+        g_free(follow_record);
+    }
+    g_list_free(follow_info->payload);
+    follow_info->payload = NULL;
+
+    return status;
+}
+
+// Write the raw data of the entire stream, which we don't keep (see
+// tapPacket()), by tapping it again.
+bool FollowStreamDialog::saveRawStream(QDataStream &out)
+{
+    follow_save_info_t save_info;
+    bool ok;
+
+    memset(&save_info.follow_info, 0, sizeof(save_info.follow_info));
+    save_info.follow_info.show_stream = follow_info_.show_stream;
+    save_info.follow_info.substream_id = follow_info_.substream_id;
+    save_info.tap_handler = get_follow_tap_handler(follower_);
+    save_info.out = &out;
+
+    if (!registerTapListener(get_follow_tap_string(follower_), &save_info,
+                             follow_filter_.toUtf8().constData(),
+                             0, FollowStreamDialog::resetStream,
+                             FollowStreamDialog::saveRawPacket, NULL)) {
+        return false;
+    }
+    // Only the frames of the stream are read and dissected; see
+    // cf_retap_packets().
+    ok = cf_retap_packets(cap_file_.capFile()) == CF_READ_OK;
+    removeTapListeners();
+    follow_reset_stream(&save_info.follow_info);
+
+    return ok;
+}
+
 void FollowStreamDialog::readStream()
 {
 
@@ -697,12 +822,12 @@ void FollowStreamDialog::showBuffer(QByteArray &buffer, size_t nchars, bool is_f
     uint32_t current_pos;
     static const char hexchars[16] = {'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
     bool show_delta = false;
+    // last_from_server_ is only meaningful once countBuffer() has seen a packet
+    bool new_turn = last_packet_ != 0 && last_from_server_ != is_from_server;
 
-    if (last_packet_ == 0) {
-        last_from_server_ = is_from_server;
-    } else {
+    if (last_packet_ != 0) {
         if (recent.gui_follow_delta == FOLLOW_DELTA_ALL ||
-            (recent.gui_follow_delta == FOLLOW_DELTA_TURN && last_from_server_ != is_from_server)) {
+            (recent.gui_follow_delta == FOLLOW_DELTA_TURN && new_turn)) {
                 show_delta = true;
         }
     }
@@ -726,7 +851,7 @@ void FollowStreamDialog::showBuffer(QByteArray &buffer, size_t nchars, bool is_f
         if (show_delta) {
             ui->teStreamContent->addDeltaTime(delta);
         }
-        if (show_delta || last_from_server_ != is_from_server) {
+        if (show_delta || new_turn) {
             addText("\n", is_from_server, packet_num);
         }
         sanitize_buffer(buffer, nchars);
@@ -742,7 +867,7 @@ void FollowStreamDialog::showBuffer(QByteArray &buffer, size_t nchars, bool is_f
         if (show_delta) {
             ui->teStreamContent->addDeltaTime(delta);
         }
-        if (show_delta || last_from_server_ != is_from_server) {
+        if (show_delta || new_turn) {
             addText("\n", is_from_server, packet_num);
         }
         sanitize_buffer(buffer, nchars);
@@ -755,7 +880,7 @@ void FollowStreamDialog::showBuffer(QByteArray &buffer, size_t nchars, bool is_f
         if (show_delta) {
             ui->teStreamContent->addDeltaTime(delta);
         }
-        if (show_delta || last_from_server_ != is_from_server) {
+        if (show_delta || new_turn) {
             addText("\n", is_from_server, packet_num);
         }
         // This assumes that multibyte characters don't span packets in the
@@ -942,6 +1067,18 @@ DIAG_ON(stringop-overread)
         ws_assert_not_reached();
     }
 
+    countBuffer(is_from_server, packet_num);
+}
+
+// Update the packet and turn counts for a buffer, whether or not it was
+// shown. Apart from resetStream(), this is the only place last_packet_
+// and last_from_server_ change.
+void FollowStreamDialog::countBuffer(bool is_from_server, uint32_t packet_num)
+{
+    if (last_packet_ == 0) {
+        last_from_server_ = is_from_server;
+    }
+
     if (packet_num != last_packet_) {
         last_packet_ = packet_num;
         if (is_from_server) {
@@ -1018,12 +1155,13 @@ bool FollowStreamDialog::follow(QString previous_filter, bool use_stream_index,
     }
 
     follow_info_.substream_id = sub_stream_num;
+    follow_filter_ = follow_filter;
 
     /* data will be passed via tap callback*/
     if (!registerTapListener(get_follow_tap_string(follower_), &follow_info_,
                                 follow_filter.toUtf8().constData(),
                                 0, FollowStreamDialog::resetStream,
-                                get_follow_tap_handler(follower_), NULL)) {
+                                FollowStreamDialog::tapPacket, NULL)) {
         return false;
     }
 
@@ -1211,7 +1349,16 @@ void FollowStreamDialog::readFollowStream()
             }
         }
 
-        if (!skip) {
+        if (!skip && follow_record->data == NULL) {
+            // We didn't keep the rest of this direction (see tapPacket()).
+            ui->teStreamContent->setTruncated();
+        }
+        if (!skip && ui->teStreamContent->isTruncated()) {
+            // Nothing more will be shown, so don't bother formatting
+            // the rest of the stream; just keep the hint label counts
+            // accurate.
+            countBuffer(follow_record->is_server, follow_record->packet_num);
+        } else if (!skip) {
             // This will only detach / deep copy if the buffer data is
             // modified. Try to avoid doing that as much as possible
             // (and avoid new memory allocations that have to be freed).
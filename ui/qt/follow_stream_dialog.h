@@ -24,6 +24,7 @@
 
 #include "wireshark_dialog.h"
 
+#include <QDataStream>
 #include <QFile>
 #include <QMap>
 #include <QPushButton>
@@ -77,8 +78,10 @@ signals:
     void goToPacket(int packet_num);
 
 private:
-    // Callback for register_tap_listener
+    // Callbacks for register_tap_listener
     static void resetStream(void *tapData);
+    static tap_packet_status tapPacket(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data, tap_flags_t flags);
+    static tap_packet_status saveRawPacket(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data, tap_flags_t flags);
 
     void removeStreamControls();
     void resetStream(void);
@@ -86,8 +89,10 @@ private:
     void updateWidgets() { updateWidgets(false); } // Needed for WiresharkDialog?
     void showBuffer(QByteArray &buffer, size_t nchars, bool is_from_server,
                 uint32_t packet_num, nstime_t abs_ts, uint32_t *global_pos);
+    void countBuffer(bool is_from_server, uint32_t packet_num);
     void readStream();
     void readFollowStream();
+    bool saveRawStream(QDataStream &out);
 
     void followStream();
     void addText(QString text, bool is_from_server, uint32_t packet_num, bool colorize = true);
@@ -102,6 +107,11 @@ private:
 
     follow_info_t           follow_info_;
     register_follow_t*      follower_;
+    QString                 follow_filter_;
+    // Payload bytes kept in follow_info_, by direction; see tapPacket()
+    static const unsigned   max_payload_bytes_;
+    unsigned                payload_bytes_[2];
+    bool                    payload_truncated_[2];
     QString                 previous_filter_;
     QString                 filter_out_filter_;
     QString                 output_filter_;
@@ -1604,8 +1604,7 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
     if (uat_model_ != NULL) {
         for (int row = 0; row < uat_model_->rowCount(); row++) {
             IOGraph *iog = ioGraphs_.value(row, NULL);
-            if (iog) {
-                iog->setInterval(interval);
+            if (iog && !iog->setInterval(interval)) {
                 if (iog->visible()) {
                     need_retap = true;
                 } else {
@@ -1617,6 +1616,8 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 
     if (need_retap) {
         scheduleRetap(true);
+    } else {
+        scheduleRecalc(true);
     }
 }
 
@@ -2172,6 +2173,29 @@ bool IOGraphDialog::saveCsv(const QString &file_name) const
 
 // IOGraph
 
+// Items are first collected at 1 ms, or at the interval itself if it's
+// finer than that or not a multiple of it.
+static int initialBaseInterval(int interval)
+{
+    return (interval > 1000 && interval % 1000 == 0) ? 1000 : interval;
+}
+
+// The next base interval up from base that still evenly divides interval.
+// Sticking to 1, 2 and 5 times powers of ten keeps it a divisor of as many
+// of the intervals in intervalComboBox as possible.
+static int coarserBaseInterval(int base, int interval)
+{
+    for (int64_t decade = 1; decade <= interval; decade *= 10) {
+        for (int64_t mult : {1, 2, 5}) {
+            int64_t candidate = decade * mult;
+            if (candidate > base && candidate % base == 0 && interval % candidate == 0) {
+                return (int)candidate;
+            }
+        }
+    }
+    return interval;
+}
+
 IOGraph::IOGraph(QCustomPlot *parent) :
     parent_(parent),
     tap_registered_(true),
@@ -2183,7 +2207,10 @@ IOGraph::IOGraph(QCustomPlot *parent) :
     interval_(0),
     start_time_(NSTIME_INIT_ZERO),
     asAOT_(false),
-    cur_idx_(-1)
+    base_interval_(0),
+    cur_idx_(-1),
+    interval_cur_idx_(-1),
+    interval_items_valid_(false)
 {
     Q_ASSERT(parent_ != NULL);
     graph_ = parent_->addGraph(parent_->xAxis, parent_->yAxis);
@@ -2616,14 +2643,15 @@ nstime_t IOGraph::startTime() const
 int IOGraph::packetFromTime(double ts) const
 {
     int idx = ts * SCALE_F / interval_;
-    if (idx >= 0 && idx <= cur_idx_) {
+    if (idx >= 0 && idx <= maxInterval()) {
+        const io_graph_item_t *item = &intervalItems()[idx];
         switch (val_units_) {
         case IOG_ITEM_UNIT_CALC_MAX:
-            return items_[idx].max_frame_in_invl;
+            return item->max_frame_in_invl;
         case IOG_ITEM_UNIT_CALC_MIN:
-            return items_[idx].min_frame_in_invl;
+            return item->min_frame_in_invl;
         default:
-            return items_[idx].last_frame_in_invl;
+            return item->last_frame_in_invl;
         }
     }
     return -1;
@@ -2635,6 +2663,10 @@ void IOGraph::clearAllData()
     if (items_.size()) {
         reset_io_graph_items(&items_[0], items_.size(), hf_index_);
     }
+    base_interval_ = initialBaseInterval(interval_);
+    interval_items_.clear();
+    interval_cur_idx_ = -1;
+    interval_items_valid_ = false;
     if (graph_) {
         graph_->data()->clear();
     }
@@ -2658,7 +2690,9 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
         bars_->data()->clear();
     }
 
-    if (moving_avg_period_ > 0 && cur_idx_ >= 0) {
+    int cur_idx = maxInterval();
+
+    if (moving_avg_period_ > 0 && cur_idx >= 0) {
         /* "Warm-up phase" - calculate average on some data not displayed;
          * just to make sure average on leftmost and rightmost displayed
          * values is as reliable as possible
@@ -2674,7 +2708,7 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
         mavg_in_average_count++;
         for (warmup_interval = interval_;
             ((warmup_interval < (0 + (moving_avg_period_ / 2) * (uint64_t)interval_)) &&
-             (warmup_interval <= (cur_idx_ * (uint64_t)interval_)));
+             (warmup_interval <= (cur_idx * (uint64_t)interval_)));
              warmup_interval += interval_) {
 
             mavg_cumulated += getItemValue((int)warmup_interval / interval_, cap_file);
@@ -2684,7 +2718,7 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
     }
 
     double ts_offset = startOffset();
-    for (int i = 0; i <= cur_idx_; i++) {
+    for (int i = 0; i <= cur_idx; i++) {
         double ts = (double) i * interval_ / SCALE_F + ts_offset;
         double val = getItemValue(i, cap_file);
 
@@ -2697,7 +2731,7 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
                     mavg_cumulated -= getItemValue((int)mavg_to_remove / interval_, cap_file);
                     mavg_to_remove += interval_;
                 }
-                if (mavg_to_add <= (unsigned int) cur_idx_ * interval_) {
+                if (mavg_to_add <= (unsigned int) cur_idx * interval_) {
                     mavg_in_average_count++;
                     mavg_cumulated += getItemValue((int)mavg_to_add / interval_, cap_file);
                     mavg_to_add += interval_;
@@ -2841,7 +2875,7 @@ bool IOGraph::hasItemToShow(int idx, double value) const
 
     bool result = false;
 
-    const io_graph_item_t *item = &items_[idx];
+    const io_graph_item_t *item = &intervalItems()[idx];
 
     switch (val_units_) {
     case IOG_ITEM_UNIT_PACKETS:
@@ -2876,12 +2910,89 @@ bool IOGraph::hasItemToShow(int idx, double value) const
     return result;
 }
 
-void IOGraph::setInterval(int interval)
+// Returns true if the items we have can be summed up to the new interval,
+// false if we need to retap.
+bool IOGraph::setInterval(int interval)
 {
     interval_ = interval;
+    interval_items_valid_ = false;
     if (bars_) {
         bars_->setWidth(interval_ / SCALE_F);
     }
+    return base_interval_ > 0 && interval_ % base_interval_ == 0;
+}
+
+int IOGraph::maxInterval() const
+{
+    if (interval_ == base_interval_) {
+        return cur_idx_;
+    }
+    if (!interval_items_valid_) {
+        rollUpItems();
+    }
+    return interval_cur_idx_;
+}
+
+// The items at interval_, which are either the collected items or
+// those summed up.
+const io_graph_item_t *IOGraph::intervalItems() const
+{
+    if (interval_ == base_interval_) {
+        return items_.data();
+    }
+    if (!interval_items_valid_) {
+        rollUpItems();
+    }
+    return interval_items_.data();
+}
+
+void IOGraph::rollUpItems() const
+{
+    interval_items_valid_ = true;
+    interval_cur_idx_ = -1;
+    if (base_interval_ <= 0 || interval_ % base_interval_ != 0 || cur_idx_ < 0) {
+        // We're waiting for a retap.
+        return;
+    }
+
+    int factor = interval_ / base_interval_;
+    int cur_idx = cur_idx_ / factor;
+    try {
+        interval_items_.resize(cur_idx + 1);
+    } catch (std::bad_alloc&) {
+        ws_warning("Failed memory allocation!");
+        return;
+    }
+    reset_io_graph_items(&interval_items_[0], interval_items_.size(), hf_index_);
+    for (int i = 0; i <= cur_idx_; i++) {
+        merge_io_graph_item(&interval_items_[i / factor], &items_[i], hf_index_);
+    }
+    interval_cur_idx_ = cur_idx;
+}
+
+// Sum up the collected items to a coarser base interval, in place.
+void IOGraph::coarsenItems(int base_interval)
+{
+    int factor = base_interval / base_interval_;
+    int cur_idx = cur_idx_ < 0 ? -1 : cur_idx_ / factor;
+
+    for (int i = 0; i <= cur_idx; i++) {
+        io_graph_item_t item;
+        int last = MIN((i + 1) * factor - 1, cur_idx_);
+
+        reset_io_graph_items(&item, 1, hf_index_);
+        for (int j = i * factor; j <= last; j++) {
+            merge_io_graph_item(&item, &items_[j], hf_index_);
+        }
+        items_[i] = item;
+    }
+    // New items are expected to be zeroed.
+    if (cur_idx_ > cur_idx) {
+        reset_io_graph_items(&items_[cur_idx + 1], cur_idx_ - cur_idx, hf_index_);
+    }
+    cur_idx_ = cur_idx;
+    base_interval_ = base_interval;
+    interval_items_valid_ = false;
 }
 
 // Get the value at the given interval (idx) for the current value unit.
@@ -2889,7 +3000,7 @@ double IOGraph::getItemValue(int idx, const capture_file *cap_file) const
 {
     ws_assert(idx < max_io_items_);
 
-    return get_io_graph_item(&items_[0], val_units_, idx, hf_index_, cap_file, interval_, cur_idx_, asAOT_);
+    return get_io_graph_item(intervalItems(), val_units_, idx, hf_index_, cap_file, interval_, maxInterval(), asAOT_);
 }
 
 // "tap_reset" callback for register_tap_listener
@@ -2910,9 +3021,20 @@ tap_packet_status IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dis
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    int64_t tmp_idx = get_io_graph_index(pinfo, iog->interval_);
+    if (iog->base_interval_ <= 0) {
+        iog->base_interval_ = initialBaseInterval(iog->interval_);
+    }
+
+    int64_t tmp_idx = get_io_graph_index(pinfo, iog->base_interval_);
     bool recalc = false;
 
+    /* Use coarser base intervals as the capture gets longer. */
+    while (tmp_idx >= max_io_base_items_ && iog->base_interval_ < iog->interval_ &&
+           iog->interval_ % iog->base_interval_ == 0) {
+        iog->coarsenItems(coarserBaseInterval(iog->base_interval_, iog->interval_));
+        tmp_idx = get_io_graph_index(pinfo, iog->base_interval_);
+    }
+
     /* some sanity checks */
     if ((tmp_idx < 0) || (tmp_idx >= max_io_items_)) {
         iog->cur_idx_ = (int)iog->items_.size() - 1;
@@ -2972,7 +3094,8 @@ tap_packet_status IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dis
         adv_edt = edt;
     }
 
-    if (!update_io_graph_item(&iog->items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->interval_)) {
+    iog->interval_items_valid_ = false;
+    if (!update_io_graph_item(&iog->items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->base_interval_)) {
         return TAP_PACKET_DONT_REDRAW;
     }
 
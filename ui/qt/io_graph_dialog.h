@@ -56,6 +56,11 @@ class QCPAxisTickerDateTime;
 // 2^25 = 16777216
 const int max_io_items_ = 1 << 25;
 
+// When the items collected at IOGraph::base_interval_ would exceed this
+// many, the base interval is made coarser. At 88 bytes per item this is
+// 22 MiB per graph, or a bit over 4 minutes of capture at 1 ms.
+const int max_io_base_items_ = 1 << 18;
+
 /* define I/O Graph specific UAT columns */
 enum UatColumnsIOG {colEnabled = 0, colAOT, colName, colDFilter, colColor, colStyle, colYAxis, colYField, colSMAPeriod, colYAxisFactor, colMaxNum};
 
@@ -90,7 +95,7 @@ public:
     QString valueUnitField() const { return vu_field_; }
     void setValueUnitField(const QString &vu_field);
     unsigned int movingAveragePeriod() const { return moving_avg_period_; }
-    void setInterval(int interval);
+    bool setInterval(int interval);
     bool addToLegend();
     bool removeFromLegend();
     QCPGraph *graph() const { return graph_; }
@@ -100,7 +105,7 @@ public:
     int packetFromTime(double ts) const;
     bool hasItemToShow(int idx, double value) const;
     double getItemValue(int idx, const capture_file *cap_file) const;
-    int maxInterval () const { return cur_idx_; }
+    int maxInterval() const;
 
     void clearAllData();
 
@@ -127,6 +132,10 @@ private:
 
     bool showsZero() const;
 
+    void coarsenItems(int base_interval);
+    const io_graph_item_t *intervalItems() const;
+    void rollUpItems() const;
+
     template<class DataMap> double maxValueFromGraphData(const DataMap &map);
     template<class DataMap> void scaleGraphData(DataMap &map, int scalar);
 
@@ -150,8 +159,17 @@ private:
 
     // Cached data. We should be able to change the Y axis without retapping as
     // much as is feasible.
+    // Items are collected at base_interval_, which evenly divides interval_
+    // and starts out at 1 ms, so that switching to another multiple of it
+    // only means summing up items instead of retapping. It's made coarser
+    // as the capture gets longer to keep the number of items reasonable.
+    int base_interval_;
     std::vector<io_graph_item_t> items_;
     int cur_idx_;
+    // items_ summed up to interval_ when it differs from base_interval_.
+    mutable std::vector<io_graph_item_t> interval_items_;
+    mutable int interval_cur_idx_;
+    mutable bool interval_items_valid_;
 };
 
 namespace Ui {
@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <stdexcept>
 
 #include "packet_list_model.h"
@@ -80,6 +81,7 @@ PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     max_line_count_(1),
     idle_dissection_row_(0)
 {
+    sort_keys_.column = -1;
     Q_ASSERT(glbl_plist_model == Q_NULLPTR);
     glbl_plist_model = this;
     setCaptureFile(cf);
@@ -172,6 +174,7 @@ void PacketListModel::clear() {
     beginResetModel();
     qDeleteAll(physical_rows_);
     PacketListRecord::invalidateAllRecords();
+    clearSortKeys();
     physical_rows_.resize(0);
     visible_rows_.resize(0);
     new_visible_rows_.resize(0);
@@ -216,6 +219,7 @@ void PacketListModel::invalidateAllColumnStrings()
     emit layoutAboutToBeChanged();
 #endif
     PacketListRecord::invalidateAllRecords();
+    clearSortKeys();
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     emit layoutChanged();
 #else
@@ -232,6 +236,7 @@ void PacketListModel::resetColumns()
     if (cap_file_) {
         PacketListRecord::resetColumns(&cap_file_->cinfo);
     }
+    clearSortKeys();
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     emit layoutChanged();
@@ -441,6 +446,7 @@ void PacketListModel::addFrameComment(const QModelIndexList &indices, const QByt
         // of just the frames changed.
         record->invalidateColorized();
         record->invalidateRecord();
+        forgetSortKey(record);
         emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
                 QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
     }
@@ -473,6 +479,7 @@ void PacketListModel::setFrameComment(const QModelIndex &index, const QByteArray
 
     record->invalidateColorized();
     record->invalidateRecord();
+    forgetSortKey(record);
     emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
             QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
 }
@@ -504,6 +511,7 @@ void PacketListModel::deleteFrameComments(const QModelIndexList &indices)
 
             record->invalidateColorized();
             record->invalidateRecord();
+            forgetSortKey(record);
             emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
                     QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
         }
@@ -531,6 +539,7 @@ void PacketListModel::deleteAllFrameComments()
 
             record->invalidateColorized();
             record->invalidateRecord();
+            forgetSortKey(record);
             row = packetNumberToRow(fdata->num);
             if (row > -1) {
                 emit dataChanged(index(row, 0), index(row, sectionMax),
@@ -578,26 +587,13 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     QString col_title = get_column_title(column);
 
-    if (text_sort_column_ >= 0 && (unsigned)visible_rows_.count() > prefs.gui_packet_list_cached_rows_max) {
-        /* Column not based on frame data but by column text that requires
-         * dissection, so to sort in a reasonable amount of time the column
-         * text needs to be cached.
-         */
-        /* If the sort is being triggered because the columns were already
-         * sorted and the filter is being cleared (or changed to something
-         * else with more rows than fit in the cache), then the temporary
-         * message will be immediately overwritten with the standard capture
-         * statistics by the packets_bar_update() call after thawing the rows.
-         * It will still blink yellow, and the user will get the message if
-         * they then click on the header file (wondering why it didn't sort.)
-         */
-        if (col_title.isEmpty()) {
-            col_title = tr("Column");
-        }
-        QString temp_msg = tr("%1 can only be sorted with %2 or fewer visible rows; increase cache size in Layout preferences").arg(col_title).arg(prefs.gui_packet_list_cached_rows_max);
-        mainApp->pushStatus(MainApplication::TemporaryStatus, temp_msg);
-        return;
-    }
+    /* Column not based on frame data but by column text that requires
+     * dissection. If the text of every visible row doesn't fit in the
+     * cache, comparing rows directly would dissect packets over and over,
+     * so collect the column's text once and sort on that instead.
+     */
+    bool use_sort_keys = text_sort_column_ >= 0 &&
+        (unsigned)visible_rows_.count() > prefs.gui_packet_list_cached_rows_max;
 
     /* If we are currently in the middle of reading the capture file, don't
      * sort. PacketList::captureFileReadFinished invalidates all the cached
@@ -645,7 +641,11 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     sort_column_is_numeric_ = isNumericColumn(sort_column_);
     QVector<PacketListRecord *> sorted_visible_rows_ = visible_rows_;
     try {
-        std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        if (use_sort_keys) {
+            sortBySortKeys(sorted_visible_rows_);
+        } else {
+            std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        }
 
         beginResetModel();
         visible_rows_.resize(0);
@@ -683,6 +683,150 @@ void PacketListModel::stopSorting()
     stop_flag_ = true;
 }
 
+// Update the progress bar and handle events every so often while sorting,
+// throwing SortAbort if the user asked us to stop.
+void PacketListModel::updateSortProgress()
+{
+    if (busy_timer_.elapsed() > busy_timeout_) {
+        if (progress_frame_) {
+            progress_frame_->setValue(static_cast<int>(comps_/exp_comps_ * 100));
+        }
+        // What's the least amount of processing that we can do which will draw
+        // the busy indicator?
+        mainApp->processEvents(QEventLoop::ExcludeSocketNotifiers, 1);
+        if (stop_flag_) {
+            throw SortAbort("Sorting aborted");
+        }
+        busy_timer_.restart();
+    }
+}
+
+void PacketListModel::clearSortKeys()
+{
+    sort_keys_.column = -1;
+    sort_keys_.text_ids.clear();
+    sort_keys_.text_to_id.clear();
+    sort_keys_.texts.clear();
+}
+
+void PacketListModel::forgetSortKey(const PacketListRecord *record)
+{
+    uint32_t num = record->frameData()->num;
+
+    if (num < static_cast<uint32_t>(sort_keys_.text_ids.size())) {
+        sort_keys_.text_ids[num] = 0;
+    }
+}
+
+// Dissect each of the rows whose text we don't have yet, interning the
+// text of the sort column. This is the slow part, so it reports progress
+// and can be stopped; what has been collected so far is kept.
+//
+// XXX - Dissection isn't thread safe, so this has to run here rather
+// than on a worker thread.
+void PacketListModel::collectSortKeys(const QVector<PacketListRecord *> &rows)
+{
+    if (sort_keys_.column != sort_column_) {
+        clearSortKeys();
+        sort_keys_.column = sort_column_;
+    }
+
+    comps_ = 0;
+    exp_comps_ = rows.count();
+    foreach (PacketListRecord *record, rows) {
+        uint32_t num = record->frameData()->num;
+
+        if (static_cast<uint32_t>(sort_keys_.text_ids.size()) <= num) {
+            sort_keys_.text_ids.resize(num + 10000);
+        }
+        if (sort_keys_.text_ids[num] == 0) {
+            QString text = record->columnStringUncached(sort_cap_file_, sort_column_);
+            uint32_t id = sort_keys_.text_to_id.value(text, 0);
+            if (id == 0) {
+                sort_keys_.texts << text;
+                id = static_cast<uint32_t>(sort_keys_.texts.count());
+                sort_keys_.text_to_id.insert(text, id);
+            }
+            sort_keys_.text_ids[num] = id;
+        }
+        comps_++;
+        updateSortProgress();
+    }
+}
+
+// Order the distinct texts the same way recordLessThan would order rows
+// with those texts, and return each text's position by ID. Texts that
+// compare equal get the same position.
+QVector<uint32_t> PacketListModel::rankSortKeys()
+{
+    const QVector<QString> &texts = sort_keys_.texts;
+    QVector<uint32_t> order(texts.count());
+    QVector<double> nums;
+    QVector<bool> nums_ok;
+
+    if (sort_column_is_numeric_) {
+        nums.resize(texts.count());
+        nums_ok.resize(texts.count());
+        for (int i = 0; i < texts.count(); i++) {
+            bool ok;
+            nums[i] = parseNumericColumn(texts[i], &ok);
+            nums_ok[i] = ok;
+        }
+    }
+
+    auto compare = [&](uint32_t a, uint32_t b) {
+        if (sort_column_is_numeric_) {
+            // Texts without a numeric value sort before the others and
+            // compare equal to each other.
+            if (!nums_ok[a] || !nums_ok[b]) {
+                return static_cast<int>(nums_ok[a]) - static_cast<int>(nums_ok[b]);
+            }
+            if (nums[a] != nums[b]) {
+                return nums[a] < nums[b] ? -1 : 1;
+            }
+        }
+        return texts[a].compare(texts[b]);
+    };
+
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return compare(a, b) < 0;
+    });
+
+    QVector<uint32_t> rank(texts.count() + 1);
+    uint32_t cur_rank = 0;
+    for (int i = 0; i < order.count(); i++) {
+        if (i > 0 && compare(order[i - 1], order[i]) != 0) {
+            cur_rank++;
+        }
+        rank[order[i] + 1] = cur_rank;
+    }
+    return rank;
+}
+
+void PacketListModel::sortBySortKeys(QVector<PacketListRecord *> &rows)
+{
+    collectSortKeys(rows);
+
+    const QVector<uint32_t> rank = rankSortKeys();
+    const QVector<uint32_t> &text_ids = sort_keys_.text_ids;
+    bool ascending = sort_order_ == Qt::AscendingOrder;
+
+    // All else being equal, compare frame numbers.
+    std::sort(rows.begin(), rows.end(), [&](PacketListRecord *r1, PacketListRecord *r2) {
+        uint32_t num1 = r1->frameData()->num;
+        uint32_t num2 = r2->frameData()->num;
+        uint32_t key1 = rank[text_ids[num1]];
+        uint32_t key2 = rank[text_ids[num2]];
+
+        if (key1 == key2) {
+            key1 = num1;
+            key2 = num2;
+        }
+        return ascending ? key1 < key2 : key1 > key2;
+    });
+}
+
 bool PacketListModel::isNumericColumn(int column)
 {
     /* XXX - Should this and ui/packet_list_utils.c right_justify_column()
@@ -769,18 +913,7 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
     // _packet_list_compare_records, and packet_list_compare_custom from
     // gtk/packet_list_store.c into one function
 
-    if (busy_timer_.elapsed() > busy_timeout_) {
-        if (progress_frame_) {
-            progress_frame_->setValue(static_cast<int>(comps_/exp_comps_ * 100));
-        }
-        // What's the least amount of processing that we can do which will draw
-        // the busy indicator?
-        mainApp->processEvents(QEventLoop::ExcludeSocketNotifiers, 1);
-        if (stop_flag_) {
-            throw SortAbort("Sorting aborted");
-        }
-        busy_timer_.restart();
-    }
+    updateSortProgress();
     if (sort_column_ < 0) {
         // No column.
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
@@ -18,6 +18,7 @@
 
 #include <QAbstractItemModel>
 #include <QFont>
+#include <QHash>
 #include <QVector>
 
 #include <ui/qt/progress_frame.h>
@@ -116,6 +117,25 @@ private:
     static ProgressFrame *progress_frame_;
     static double exp_comps_;
     static double comps_;
+    static void updateSortProgress();
+
+    // The text of one dissection-based column for every row, collected
+    // when sorting more rows than the column text cache can hold. Each
+    // distinct text is stored once, and rows refer to it by a 1-based ID
+    // indexed by frame number; 0 means it hasn't been collected yet.
+    // Kept until the column text changes, so re-sorting is cheap.
+    struct SortKeyColumn {
+        int column;
+        QVector<uint32_t> text_ids;
+        QHash<QString, uint32_t> text_to_id;
+        QVector<QString> texts;
+    };
+    SortKeyColumn sort_keys_;
+    void clearSortKeys();
+    void forgetSortKey(const PacketListRecord *record);
+    void collectSortKeys(const QVector<PacketListRecord *> &rows);
+    QVector<uint32_t> rankSortKeys();
+    void sortBySortKeys(QVector<PacketListRecord *> &rows);
 
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
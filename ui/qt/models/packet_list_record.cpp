@@ -89,6 +89,24 @@ const QString PacketListRecord::columnString(capture_file *cap_file, int column,
     return col_text ? col_text->at(column) : QString();
 }
 
+const QString PacketListRecord::columnStringUncached(capture_file *cap_file, int column)
+{
+    Q_ASSERT(fdata_);
+
+    if (!cap_file || column < 0 || column >= cap_file->cinfo.num_cols) {
+        return QString();
+    }
+
+    QStringList *col_text = col_text_cache_.object(fdata_->num);
+    if (col_text != nullptr && column < col_text->count() && !col_text->at(column).isNull()) {
+        return col_text->at(column);
+    }
+
+    QString text;
+    dissect(cap_file, true, false, column, &text);
+    return text;
+}
+
 void PacketListRecord::resetColumns(column_info *cinfo)
 {
     invalidateAllRecords();
@@ -107,7 +125,8 @@ void PacketListRecord::resetColumns(column_info *cinfo)
     }
 }
 
-void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color)
+void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color,
+                               int text_column, QString *column_text)
 {
     // packet_list_store.c:packet_list_dissect_and_cache_record
     epan_dissect_t edt;
@@ -146,7 +165,11 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, boo
         if (dissect_columns) {
             col_fill_in_error(cinfo, fdata_, false, false /* fill_fd_columns */);
 
-            cacheColumnStrings(cinfo);
+            if (column_text) {
+                *column_text = QString(get_column_text(cinfo, text_column));
+            } else {
+                cacheColumnStrings(cinfo);
+            }
         }
         if (dissect_color) {
             fdata_->color_filter = NULL;
@@ -196,7 +219,11 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, boo
     if (dissect_columns) {
         /* "Stringify" non frame_data vals */
         epan_dissect_fill_in_columns(&edt, false, false /* fill_fd_columns */);
-        cacheColumnStrings(cinfo);
+        if (column_text) {
+            *column_text = QString(get_column_text(cinfo, text_column));
+        } else {
+            cacheColumnStrings(cinfo);
+        }
     }
 
     if (dissect_color) {
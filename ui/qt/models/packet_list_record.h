@@ -35,6 +35,9 @@ public:
     void ensureColorized(capture_file *cap_file);
     // Return the string value for a column. Data is cached if possible.
     const QString columnString(capture_file *cap_file, int column, bool colorized = false);
+    // Return the string value for a column without adding it to the cache,
+    // so that visiting every record doesn't evict everything else.
+    const QString columnStringUncached(capture_file *cap_file, int column);
     frame_data *frameData() const { return fdata_; }
     // packet_list->col_to_text in gtk/packet_list_store.c
     static int textColumn(int column) { return cinfo_column_.value(column, -1); }
@@ -75,7 +78,8 @@ private:
 
     bool read_failed_;
 
-    void dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color = false);
+    void dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color = false,
+                 int text_column = -1, QString *column_text = nullptr);
     void cacheColumnStrings(column_info *cinfo);
 };
 
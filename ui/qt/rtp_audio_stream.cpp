@@ -180,15 +180,38 @@ void RtpAudioStream::setAudioRouting(AudioRouting audio_routing)
 }
 
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-void RtpAudioStream::decode(QAudioDevice out_device)
+void RtpAudioStream::prepareDecode(QAudioDevice out_device)
 #else
-void RtpAudioStream::decode(QAudioDeviceInfo out_device)
+void RtpAudioStream::prepareDecode(QAudioDeviceInfo out_device)
 #endif
+{
+    // The sample rate is only known once decodeAudio() has decoded a
+    // packet, so work out the output rate for the rates codecs commonly
+    // decode to and for the clock rates of the stream's payload types.
+    static const unsigned int common_rates[] = { 8000, 16000, 32000, 44100, 48000 };
+    QSet<unsigned int> sample_rates;
+
+    for (unsigned int rate : common_rates) {
+        sample_rates << rate;
+    }
+    for (const rtp_packet_t *rtp_packet : rtp_packets_) {
+        if (rtp_packet->info->info_payload_rate > 0) {
+            sample_rates << (unsigned int)rtp_packet->info->info_payload_rate;
+        }
+    }
+
+    audio_out_rates_.clear();
+    for (unsigned int rate : sample_rates) {
+        audio_out_rates_[rate] = calculateAudioOutRate(out_device, rate, audio_requested_out_rate_);
+    }
+}
+
+void RtpAudioStream::decode()
 {
     if (rtp_packets_.size() < 1) return;
 
     audio_file_->setFrameWriteStage();
-    decodeAudio(out_device);
+    decodeAudio();
 
     // Skip silence at begin of the stream
     audio_file_->setFrameReadStage(prepend_samples_);
@@ -250,11 +273,7 @@ quint32 RtpAudioStream::calculateAudioOutRate(QAudioDeviceInfo out_device, unsig
     return out_rate;
 }
 
-#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-void RtpAudioStream::decodeAudio(QAudioDevice out_device)
-#else
-void RtpAudioStream::decodeAudio(QAudioDeviceInfo out_device)
-#endif
+void RtpAudioStream::decodeAudio()
 {
     // XXX This is more messy than it should be.
 
@@ -332,8 +351,9 @@ void RtpAudioStream::decodeAudio(QAudioDeviceInfo out_device)
 
             // We calculate audio_out_rate just for first sample_rate.
             // All later are just resampled to it.
-            // Side effect: it creates and initiates resampler if needed
-            audio_out_rate_ = calculateAudioOutRate(out_device, sample_rate, audio_requested_out_rate_);
+            // prepareDecode() worked it out on the GUI thread; play a
+            // rate it didn't expect as it is.
+            audio_out_rate_ = audio_out_rates_.value(sample_rate, sample_rate);
 
             // Calculate count of prepend samples for the stream
             // The earliest stream starts at 0.
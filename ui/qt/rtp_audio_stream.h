@@ -53,11 +53,22 @@ public:
     void reset(double global_start_time);
     AudioRouting getAudioRouting();
     void setAudioRouting(AudioRouting audio_routing);
+    /**
+     * @brief Work out the rates at which the stream may be played on
+     * out_device. Must be called on the GUI thread before decode(), as
+     * audio devices can't be queried from other threads. Doesn't decode
+     * anything.
+     */
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-    void decode(QAudioDevice out_device);
+    void prepareDecode(QAudioDevice out_device);
 #else
-    void decode(QAudioDeviceInfo out_device);
+    void prepareDecode(QAudioDeviceInfo out_device);
 #endif
+    /**
+     * @brief Decode the stream. Only uses the stream's own state, so
+     * several streams can be decoded in parallel.
+     */
+    void decode();
 
     double startRelTime() const { return start_rel_time_; }
     double stopRelTime() const { return stop_rel_time_; }
@@ -192,6 +203,7 @@ private:
     quint32 first_sample_rate_;
     quint32 audio_out_rate_;
     quint32 audio_requested_out_rate_;
+    QMap<unsigned int, quint32> audio_out_rates_; // Output rate on the device per sample rate, from prepareDecode()
     QSet<QString> payload_names_;
     struct SpeexResamplerState_ *visual_resampler_;
     QMap<double, quint32> packet_timestamps_;
@@ -213,13 +225,12 @@ private:
 
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
     QAudioSink *audio_output_;
-    void decodeAudio(QAudioDevice out_device);
     quint32 calculateAudioOutRate(QAudioDevice out_device, unsigned int sample_rate, unsigned int requested_out_rate);
 #else
     QAudioOutput *audio_output_;
-    void decodeAudio(QAudioDeviceInfo out_device);
     quint32 calculateAudioOutRate(QAudioDeviceInfo out_device, unsigned int sample_rate, unsigned int requested_out_rate);
 #endif
+    void decodeAudio();
     void decodeVisual();
     SAMPLE *resizeBufferIfNeeded(SAMPLE *buff, int32_t *buff_bytes, qint64 requested_size);
 
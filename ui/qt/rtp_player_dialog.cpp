@@ -60,13 +60,11 @@
 
 #include <QPushButton>
 #include <QToolButton>
+#include <QtConcurrent>
 
 #include <ui/qt/utils/stock_icon.h>
 #include "main_application.h"
 
-// To do:
-// - Threaded decoding?
-
 // Current and former RTP player bugs. Many have attachments that can be usef for testing.
 // Bug 3368 - The timestamp line in a RTP or RTCP packet display's "Not Representable"
 // Bug 3952 - VoIP Call RTP Player: audio played is corrupted when RFC2833 packets are present
@@ -173,6 +171,8 @@ RtpPlayerDialog::RtpPlayerDialog(QWidget &parent, CaptureFile &cf, bool capture_
     , listener_removed_(true)
     , block_redraw_(false)
     , lock_ui_(0)
+    , decoding_(false)
+    , decode_rescale_axes_(false)
     , read_capture_enabled_(capture_running)
     , silence_skipped_time_(0.0)
 #endif // QT_MULTIMEDIA_LIB
@@ -221,6 +221,8 @@ RtpPlayerDialog::RtpPlayerDialog(QWidget &parent, CaptureFile &cf, bool capture_
     connect(ui->audioPlot, &QCustomPlot::mouseDoubleClick, this, &RtpPlayerDialog::graphDoubleClicked);
     connect(ui->audioPlot, &QCustomPlot::plottableClick, this, &RtpPlayerDialog::plotClicked);
 
+    connect(&decode_watcher_, &QFutureWatcher<void>::finished, this, &RtpPlayerDialog::decodeFinished);
+
     cur_play_pos_ = new QCPItemStraightLine(ui->audioPlot);
     cur_play_pos_->setVisible(false);
 
@@ -400,6 +402,7 @@ RtpPlayerDialog::~RtpPlayerDialog()
 {
     std::lock_guard<std::mutex> lock(init_mutex_);
     if (pinstance_ != nullptr) {
+        waitForDecode();
         for (int row = 0; row < ui->streamTreeWidget->topLevelItemCount(); row++) {
             QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
             RtpAudioStream *audio_stream = ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>();
@@ -441,6 +444,7 @@ void RtpPlayerDialog::retapPackets()
         return;
     }
     lockUI();
+    waitForDecode();
     ui->hintLabel->setText("<i><small>" + tr("Decoding streams...") + "</i></small>");
     mainApp->processEvents();
 
@@ -488,6 +492,16 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
     ui->hintLabel->setText("<i><small>" + tr("Decoding streams...") + "</i></small>");
     mainApp->processEvents();
 
+    if (decoding_) {
+        // Start over. The previous decode's lock is released by
+        // decodeFinished(), so drop ours.
+        decode_watcher_.cancel();
+        decode_watcher_.waitForFinished();
+        unlockUI();
+    }
+    decoding_ = true;
+    decode_rescale_axes_ = decode_rescale_axes_ || rescale_axes;
+
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
     QAudioDevice cur_out_device = getCurrentDeviceInfo();
 #else
@@ -495,6 +509,8 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
 #endif
     int row_count = ui->streamTreeWidget->topLevelItemCount();
 
+    decode_streams_.clear();
+
     // Reset stream values
     for (int row = 0; row < row_count; row++) {
         QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
@@ -517,11 +533,28 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
         }
         audio_stream->setTimingMode(timing_mode);
 
-	       //if (!cur_out_device.isNull()) {
-            audio_stream->decode(cur_out_device);
-        //}
+        // Audio devices can only be queried from here.
+        audio_stream->prepareDecode(cur_out_device);
+
+        decode_streams_ << audio_stream;
     }
 
+    // Each stream has its own decoders, resamplers and audio file, so
+    // decode them in parallel, without blocking the GUI. The UI stays
+    // locked until decodeFinished().
+    decode_watcher_.setFuture(QtConcurrent::map(decode_streams_, [](RtpAudioStream *audio_stream) {
+        audio_stream->decode();
+    }));
+}
+
+void RtpPlayerDialog::decodeFinished()
+{
+    bool rescale_axes = decode_rescale_axes_;
+
+    decoding_ = false;
+    decode_rescale_axes_ = false;
+    decode_streams_.clear();
+
     for (int col = 0; col < ui->streamTreeWidget->columnCount() - 1; col++) {
         ui->streamTreeWidget->resizeColumnToContents(col);
     }
@@ -532,6 +565,15 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
     unlockUI();
 }
 
+// Let any decoding in progress finish before the streams are changed
+// from outside of the dialog.
+void RtpPlayerDialog::waitForDecode()
+{
+    if (decoding_) {
+        decode_watcher_.waitForFinished();
+    }
+}
+
 void RtpPlayerDialog::createPlot(bool rescale_axes)
 {
     bool legend_out_of_sequence = false;
@@ -806,6 +848,7 @@ void RtpPlayerDialog::replaceRtpStreams(QVector<rtpstream_id_t *> stream_ids)
     std::unique_lock<std::mutex> lock(run_mutex_, std::try_to_lock);
     if (lock.owns_lock()) {
         lockUI();
+        waitForDecode();
 
         // Delete all existing rows
         if (last_ti_) {
@@ -864,6 +907,7 @@ void RtpPlayerDialog::removeRtpStreams(QVector<rtpstream_id_t *> stream_ids)
     std::unique_lock<std::mutex> lock(run_mutex_, std::try_to_lock);
     if (lock.owns_lock()) {
         lockUI();
+        waitForDecode();
         int tli_count = ui->streamTreeWidget->topLevelItemCount();
 
         for (int i=0; i < stream_ids.size(); i++) {
@@ -32,6 +32,7 @@
 # else
 # include <QAudioDeviceInfo>
 # endif
+# include <QFutureWatcher>
 #endif
 
 namespace Ui {
@@ -138,9 +139,11 @@ private slots:
      */
     void retapPackets();
     void captureEvent(CaptureEvent e);
-    /** Clear, decode, and redraw each stream.
+    /** Clear, decode, and redraw each stream. The streams are decoded
+     * in the background and redrawn by ::decodeFinished.
      */
     void rescanPackets(bool rescale_axes = false);
+    void decodeFinished();
     void createPlot(bool rescale_axes = false);
     void updateWidgets();
     void itemEntered(QTreeWidgetItem *item, int column);
@@ -249,6 +252,10 @@ private:
     QMultiHash<unsigned, RtpAudioStream *> stream_hash_;
     bool block_redraw_;
     int lock_ui_;
+    QFutureWatcher<void> decode_watcher_;
+    QList<RtpAudioStream *> decode_streams_;    // Streams being decoded
+    bool decoding_;
+    bool decode_rescale_axes_;
     bool read_capture_enabled_;
     double silence_skipped_time_;
     QTimer *mouse_update_timer_;
@@ -304,6 +311,7 @@ private:
     void savePayload();
     void lockUI();
     void unlockUI();
+    void waitForDecode();
     void selectInaudible(bool select);
     QVector<rtpstream_id_t *>getSelectedRtpStreamIDs();
     void fillTappedColumns();
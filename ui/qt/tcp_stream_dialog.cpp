@@ -11,6 +11,7 @@
 #include <ui_tcp_stream_dialog.h>
 
 #include <algorithm> // for std::sort
+#include <cmath>
 #include <utility> // for std::pair
 #include <vector>
 
@@ -117,6 +118,7 @@ TCPStreamDialog::TCPStreamDialog(QWidget *parent, capture_file *cf, tcp_graph_ty
     dup_ack_graph_(nullptr),
     zero_win_graph_(nullptr),
     tracer_(nullptr),
+    segment_bars_pixels_(0),
     packet_num_(0),
     mouse_drags_(true),
     rubber_band_(nullptr),
@@ -328,6 +330,17 @@ TCPStreamDialog::TCPStreamDialog(QWidget *parent, capture_file *cf, tcp_graph_ty
     zero_win_graph_->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCross, graph_color_1, 5));
 
     tracer_ = new QCPItemTracer(sp);
+    connect(sp->xAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(updateSegmentBars()));
+    // The bars are merged for the width of the axis rect, which isn't
+    // known until the plot has been laid out and changes whenever the
+    // dialog is resized. Merge them again once resizing has settled.
+    segment_bars_timer_.setSingleShot(true);
+    segment_bars_timer_.setInterval(100);
+    connect(&segment_bars_timer_, &QTimer::timeout, this, [this]() {
+        updateSegmentBars();
+        ui->streamPlot->replot();
+    });
+    connect(sp, SIGNAL(afterLayout()), this, SLOT(plotLayoutChanged()));
 
     // Triggers fillGraph() [ UNLESS the index is already graph_idx!! ]
     if (graph_idx != ui->graphTypeComboBox->currentIndex())
@@ -585,6 +598,9 @@ void TCPStreamDialog::fillGraph(bool reset_axes, bool set_focus)
     int pkts_rev = 0;
 
     time_stamp_map_.clear();
+    seg_bars_.clear();
+    sack_bars_.clear();
+    sack2_bars_.clear();
     for (struct segment *seg = graph_.segments; seg != NULL; seg = seg->next) {
         // NOTE - adding both forward and reverse packets to time_stamp_map_
         //   so that both data and acks are selectable
@@ -633,9 +649,18 @@ void TCPStreamDialog::fillGraph(bool reset_axes, bool set_focus)
             }
         }
         if (insert) {
-            time_stamp_map_.insert(ts - ts_offset_, seg);
+            time_stamp_map_.emplace_back(ts - ts_offset_, seg);
         }
     }
+    // Segments are normally in time order already. Keep the original
+    // order for equal time stamps so that segmentAtTime() returns the
+    // last one.
+    auto ts_less = [](const std::pair<double, struct segment *> &a, const std::pair<double, struct segment *> &b) {
+        return a.first < b.first;
+    };
+    if (!std::is_sorted(time_stamp_map_.begin(), time_stamp_map_.end(), ts_less)) {
+        std::stable_sort(time_stamp_map_.begin(), time_stamp_map_.end(), ts_less);
+    }
 
     switch (graph_.type) {
     case GRAPH_TSEQ_STEVENS:
@@ -862,10 +887,7 @@ void TCPStreamDialog::fillTcptrace()
     zero_win_graph_->setVisible(true);
 
     QVector<double> pkt_time, pkt_seqnums;
-    QVector<double> sb_time, sb_center, sb_span;
     QVector<double> ackrwin_time, ack, rwin;
-    QVector<double> sack_time, sack_center, sack_span;
-    QVector<double> sack2_time, sack2_center, sack2_span;
     QVector<double> dup_ack_time, dup_ack;
     QVector<double> zero_win_time, zero_win;
 
@@ -883,9 +905,9 @@ void TCPStreamDialog::fillTcptrace()
             // QCP doesn't have a segment graph type. For now, fake
             // it with error bars.
             if (seg->th_seglen > 0) {
-                sb_time.append(ts);
-                sb_center.append(center);
-                sb_span.append(half);
+                seg_bars_.time.append(ts);
+                seg_bars_.center.append(center);
+                seg_bars_.span.append(half);
             }
 
             // Look for zero window sizes.
@@ -907,17 +929,17 @@ void TCPStreamDialog::fillTcptrace()
                 half = half/2.0;
                 double center = seg->sack_left_edge[i] - seq_offset_ + half;
                 if (i == 0) {
-                    sack_time.append(ts);
-                    sack_center.append(center);
-                    sack_span.append(half);
+                    sack_bars_.time.append(ts);
+                    sack_bars_.center.append(center);
+                    sack_bars_.span.append(half);
                     if (allow_sack_select) {
                         pkt_time.append(ts);
                         pkt_seqnums.append(center);
                     }
                 } else {
-                    sack2_time.append(ts);
-                    sack2_center.append(center);
-                    sack2_span.append(half);
+                    sack2_bars_.time.append(ts);
+                    sack2_bars_.center.append(center);
+                    sack2_bars_.span.append(half);
                 }
             }
             // If ackno is the same as our last one mark it as a duplicate.
@@ -935,18 +957,108 @@ void TCPStreamDialog::fillTcptrace()
     }
     base_graph_->setData(pkt_time, pkt_seqnums, true);
     ack_graph_->setData(ackrwin_time, ack, true);
-    seg_graph_->setData(sb_time, sb_center, true);
-    seg_eb_->setData(sb_span);
-    sack_graph_->setData(sack_time, sack_center, true);
-    sack_eb_->setData(sack_span);
-    sack2_graph_->setData(sack2_time, sack2_center, true);
-    sack2_eb_->setData(sack2_span);
+    seg_bars_.sorted = std::is_sorted(seg_bars_.time.cbegin(), seg_bars_.time.cend());
+    sack_bars_.sorted = std::is_sorted(sack_bars_.time.cbegin(), sack_bars_.time.cend());
+    sack2_bars_.sorted = std::is_sorted(sack2_bars_.time.cbegin(), sack2_bars_.time.cend());
+    updateSegmentBars();
     rwin_graph_->setValueAxis(sp->yAxis);
     rwin_graph_->setData(ackrwin_time, rwin, true);
     dup_ack_graph_->setData(dup_ack_time, dup_ack, true);
     zero_win_graph_->setData(zero_win_time, zero_win, true);
 }
 
+// Give QCustomPlot the bars in the visible key range, merging the ones
+// that fall into the same pixel column into a single bar spanning their
+// minimum and maximum. The bars on either side of the visible range are
+// merged into one each so that rescaling the axes still sees the full
+// extent of the data.
+void TCPStreamDialog::setSegmentBars(QCPGraph *graph, QCPErrorBars *error_bars, const SegmentBars &bars)
+{
+    QCPAxis *key_axis = graph->keyAxis();
+    const QCPRange range = key_axis->range();
+    const int pixels = qMax(1, key_axis->axisRect()->width());
+    const int count = static_cast<int>(bars.time.size());
+
+    if (count <= pixels * 2 || !bars.sorted) {
+        graph->setData(bars.time, bars.center, true);
+        error_bars->setData(bars.span);
+        return;
+    }
+
+    QVector<double> time, center, span;
+    time.reserve(pixels + 2);
+    center.reserve(pixels + 2);
+    span.reserve(pixels + 2);
+
+    // Merge bars [first, last) into one placed at key_idx.
+    auto addMerged = [&](int first, int last, int key_idx) {
+        double lo = bars.center[first] - bars.span[first];
+        double hi = bars.center[first] + bars.span[first];
+        for (int i = first + 1; i < last; i++) {
+            lo = qMin(lo, bars.center[i] - bars.span[i]);
+            hi = qMax(hi, bars.center[i] + bars.span[i]);
+        }
+        time.append(bars.time[key_idx]);
+        center.append((lo + hi) / 2.0);
+        span.append((hi - lo) / 2.0);
+    };
+
+    int begin = static_cast<int>(std::lower_bound(bars.time.cbegin(), bars.time.cend(), range.lower) - bars.time.cbegin());
+    int end = static_cast<int>(std::upper_bound(bars.time.cbegin(), bars.time.cend(), range.upper) - bars.time.cbegin());
+
+    if (begin > 0) {
+        addMerged(0, begin, 0);
+    }
+
+    if (end - begin <= pixels) {
+        for (int i = begin; i < end; i++) {
+            time.append(bars.time[i]);
+            center.append(bars.center[i]);
+            span.append(bars.span[i]);
+        }
+    } else {
+        double bucket_width = range.size() / pixels;
+        int i = begin;
+        while (i < end) {
+            double bucket = std::floor((bars.time[i] - range.lower) / bucket_width);
+            double bucket_end = range.lower + (bucket + 1) * bucket_width;
+            int j = i + 1;
+            while (j < end && bars.time[j] < bucket_end) {
+                j++;
+            }
+            addMerged(i, j, i);
+            i = j;
+        }
+    }
+
+    if (end < count) {
+        addMerged(end, count, count - 1);
+    }
+
+    graph->setData(time, center, true);
+    error_bars->setData(span);
+}
+
+void TCPStreamDialog::updateSegmentBars()
+{
+    // Only the tcptrace graph has bars.
+    if (!seg_eb_->visible()) {
+        return;
+    }
+
+    segment_bars_pixels_ = seg_graph_->keyAxis()->axisRect()->width();
+    setSegmentBars(seg_graph_, seg_eb_, seg_bars_);
+    setSegmentBars(sack_graph_, sack_eb_, sack_bars_);
+    setSegmentBars(sack2_graph_, sack2_eb_, sack2_bars_);
+}
+
+void TCPStreamDialog::plotLayoutChanged()
+{
+    if (seg_eb_->visible() && ui->streamPlot->axisRect()->width() != segment_bars_pixels_) {
+        segment_bars_timer_.start();
+    }
+}
+
 // If the current implementation of incorporating SACKs in goodput calc
 //   is slow, comment out the following line to ignore SACKs in goodput calc.
 #define USE_SACKS_IN_GOODPUT_CALC
@@ -1784,6 +1896,19 @@ void TCPStreamDialog::axisClicked(QCPAxis *axis, QCPAxis::SelectablePart, QMouse
     }
 }
 
+// Return the last segment at exactly the given time.
+struct segment *TCPStreamDialog::segmentAtTime(double ts)
+{
+    auto it = std::upper_bound(time_stamp_map_.cbegin(), time_stamp_map_.cend(), ts,
+                               [](double key, const std::pair<double, struct segment *> &item) {
+        return key < item.first;
+    });
+    if (it == time_stamp_map_.cbegin() || (--it)->first != ts) {
+        return NULL;
+    }
+    return it->second;
+}
+
 // Setting mouseTracking on our streamPlot may not be as reliable
 // as we need. If it's not we might want to poll the mouse position
 // using a QTimer instead.
@@ -1825,13 +1950,13 @@ void TCPStreamDialog::mouseMoved(QMouseEvent *event)
             case GRAPH_TSEQ_TCPTRACE:
             case GRAPH_THROUGHPUT:
             case GRAPH_WSCALE:
-                packet_seg = time_stamp_map_.value(tr_key, NULL);
+                packet_seg = segmentAtTime(tr_key);
                 break;
             case GRAPH_RTT:
                 if (ui->bySeqNumberCheckBox->isChecked())
                     packet_seg = sequence_num_map_.value(tr_key, NULL);
                 else
-                    packet_seg = time_stamp_map_.value(tr_key, NULL);
+                    packet_seg = segmentAtTime(tr_key);
             default:
                 break;
             }
@@ -25,6 +25,9 @@
 #include <QRubberBand>
 #include <QTimer>
 
+#include <utility>
+#include <vector>
+
 namespace Ui {
 class TCPStreamDialog;
 class QCPErrorBarsNotSelectable;
@@ -65,7 +68,9 @@ protected:
 private:
     Ui::TCPStreamDialog *ui;
     capture_file *cap_file_;
-    QMultiMap<double, struct segment *> time_stamp_map_;
+    // Sorted by time stamp. Kept in a vector instead of a QMultiMap,
+    // which allocates a node per segment.
+    std::vector<std::pair<double, struct segment *>> time_stamp_map_;
     double ts_offset_;
     bool ts_origin_conn_;
     QMap<double, struct segment *> sequence_num_map_;
@@ -88,6 +93,22 @@ private:
     QCPGraph *dup_ack_graph_;
     QCPGraph *zero_win_graph_;
     QCPItemTracer *tracer_;
+
+    // tcptrace segment and SACK bars. QCPErrorBars has no adaptive
+    // sampling, so we hand it at most one bar per pixel of the visible
+    // range and redo that whenever the key range changes.
+    struct SegmentBars {
+        QVector<double> time;
+        QVector<double> center;
+        QVector<double> span;
+        bool sorted = true;
+        void clear() { time.clear(); center.clear(); span.clear(); sorted = true; }
+    };
+    SegmentBars seg_bars_;
+    SegmentBars sack_bars_;
+    SegmentBars sack2_bars_;
+    int segment_bars_pixels_;   // Axis rect width the bars were merged for
+    QTimer segment_bars_timer_; // Merges them again after a resize
     QRectF axis_bounds_;
     uint32_t packet_num_;
     QTransform y_axis_xfrm_;
@@ -133,6 +154,8 @@ private:
     void fillThroughput();
     void fillRoundTripTime();
     void fillWindowScale();
+    void setSegmentBars(QCPGraph *graph, QCPErrorBars *error_bars, const SegmentBars &bars);
+    struct segment *segmentAtTime(double ts);
     QString streamDescription();
     bool compareHeaders(struct segment *seg);
     void toggleTracerStyle(bool force_default = false);
@@ -145,6 +168,8 @@ private slots:
     void mouseMoved(QMouseEvent *event);
     void mouseReleased(QMouseEvent *event);
     void transformYRange(const QCPRange &y_range1);
+    void updateSegmentBars();
+    void plotLayoutChanged();
     void on_buttonBox_accepted();
     void on_graphTypeComboBox_currentIndexChanged(int index);
     void on_resetButton_clicked();
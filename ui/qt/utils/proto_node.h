@@ -54,8 +54,14 @@ public:
 
 private:
     proto_node * node_;
-    QVector<ProtoNode*>m_children;
+    // Children are created when they're first asked for, so that only
+    // the parts of a large tree that are shown get a ProtoNode.
+    mutable QVector<ProtoNode*>m_children;
+    mutable bool children_populated_;
     ProtoNode *parent_;
+    int row_;
+    ProtoNode(proto_node * node, ProtoNode *parent, int row);
+    void populateChildren() const;
     static bool isHidden(proto_node * node);
 };
 
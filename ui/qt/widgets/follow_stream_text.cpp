@@ -113,6 +113,21 @@ void FollowStreamText::addDeltaTime(double delta)
     setUpdatesEnabled(true);
 }
 
+// Stop adding text before reaching max_document_length_, e.g. because
+// the rest of the stream isn't available.
+void FollowStreamText::setTruncated()
+{
+    if (truncated_) {
+        return;
+    }
+    truncated_ = true;
+
+    setUpdatesEnabled(false);
+    moveCursor(QTextCursor::End);
+    addTruncated(verticalScrollBar()->value());
+    setUpdatesEnabled(true);
+}
+
 void FollowStreamText::mouseMoveEvent(QMouseEvent *event)
 {
     emit mouseMovedToPacket(textPosToPacket(cursorForPosition(event->pos()).position()));
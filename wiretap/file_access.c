@@ -16,6 +16,7 @@
 #include <errno.h>
 
 #include <wsutil/file_util.h>
+#include <wsutil/shm_ring.h>
 #include <wsutil/tempfile.h>
 #ifdef HAVE_PLUGINS
 #include <wsutil/plugins.h>
@@ -907,7 +908,17 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 		use_stdin = true;
 
 	/* First, make sure the file is valid */
-	if (use_stdin) {
+	if (shm_ring_path_name(filename) != NULL) {
+		/*
+		 * A shared memory ring dumpcap is writing to; it can
+		 * only be read sequentially, like a pipe.
+		 */
+		if (do_random) {
+			*err = WTAP_ERR_RANDOM_OPEN_PIPE;
+			return NULL;
+		}
+		ispipe = true;
+	} else if (use_stdin) {
 		if (ws_fstat64(0, &statb) < 0) {
 			*err = errno;
 			return NULL;
@@ -918,7 +929,9 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 			return NULL;
 		}
 	}
-	if (S_ISFIFO(statb.st_mode)) {
+	if (ispipe) {
+		/* Nothing more to check. */
+	} else if (S_ISFIFO(statb.st_mode)) {
 		/*
 		 * Opens of FIFOs are allowed only when not opening
 		 * for random access.
@@ -2664,6 +2677,23 @@ wtap_dump_discard_sysdig_meta_events(wtap_dumper *wdh)
 	}
 }
 
+/*
+ * Size of the standard I/O buffer for uncompressed output. The default
+ * is often just the file system block size, which turns writing lots of
+ * small records into lots of small writes.
+ */
+#define WTAP_DUMP_IO_BUF_SIZE	(256 * 1024)
+
+static FILE *
+wtap_dump_file_setvbuf(wtap_dumper *wdh, FILE *fh)
+{
+	if (fh != NULL) {
+		wdh->io_buffer = (char *)g_malloc(WTAP_DUMP_IO_BUF_SIZE);
+		setvbuf(fh, wdh->io_buffer, _IOFBF, WTAP_DUMP_IO_BUF_SIZE);
+	}
+	return fh;
+}
+
 /* internally open a file for writing (compressed or not) */
 static WFILE_T
 wtap_dump_file_open(wtap_dumper *wdh, const char *filename)
@@ -2678,7 +2708,7 @@ wtap_dump_file_open(wtap_dumper *wdh, const char *filename)
 		return lz4wfile_open(filename);
 #endif /* HAVE_LZ4FRAME_H */
 	default:
-		return ws_fopen(filename, "wb");
+		return wtap_dump_file_setvbuf(wdh, ws_fopen(filename, "wb"));
 	}
 }
 
@@ -2696,7 +2726,7 @@ wtap_dump_file_fdopen(wtap_dumper *wdh, int fd)
 		return lz4wfile_fdopen(fd);
 #endif /* HAVE_LZ4FRAME_H */
 	default:
-		return ws_fdopen(fd, "wb");
+		return wtap_dump_file_setvbuf(wdh, ws_fdopen(fd, "wb"));
 	}
 }
 
@@ -2764,7 +2794,14 @@ wtap_dump_file_close(wtap_dumper *wdh)
 		return lz4wfile_close((LZ4WFILE_T)wdh->fh);
 #endif /* HAVE_LZ4FRAME_H */
 	default:
-		return fclose((FILE *)wdh->fh);
+	{
+		int ret = fclose((FILE *)wdh->fh);
+
+		/* The stream is gone, so nothing uses its buffer any more. */
+		g_free(wdh->io_buffer);
+		wdh->io_buffer = NULL;
+		return ret;
+	}
 	}
 }
 
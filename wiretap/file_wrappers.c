@@ -26,6 +26,7 @@
 #include "wtap-int.h"
 
 #include <wsutil/file_util.h>
+#include <wsutil/shm_ring.h>
 
 #if defined(HAVE_ZLIB) && !defined(HAVE_ZLIBNG)
 #define USE_ZLIB_OR_ZLIBNG
@@ -221,6 +222,7 @@ struct wtap_reader_buf {
 
 struct wtap_reader {
     int fd;                     /* file descriptor */
+    shm_ring_t *shm;            /* shared memory ring we read from instead of fd, if any */
     int64_t raw_pos;            /* current position in file (just to not call lseek()) */
     int64_t pos;                /* current position in uncompressed data */
     unsigned size;              /* buffer size */
@@ -328,7 +330,10 @@ buf_read(FILE_T state, struct wtap_reader_buf *buf)
         to_read = space_left;
     }
 
-    ret = ws_read(state->fd, read_ptr, to_read);
+    if (state->shm != NULL)
+        ret = shm_ring_read(state->shm, read_ptr, to_read);
+    else
+        ret = ws_read(state->fd, read_ptr, to_read);
     if (ret < 0) {
         state->err = errno;
         state->err_info = NULL;
@@ -1636,8 +1641,8 @@ gz_reset(FILE_T state)
     buf_reset(&state->in);        /* no input data yet */
 }
 
-FILE_T
-file_fdopen(int fd)
+static FILE_T
+file_reader_open(int fd)
 {
     /*
      * XXX - we now check whether we have st_blksize in struct stat;
@@ -1669,9 +1674,6 @@ file_fdopen(int fd)
     size_t ret;
 #endif /* USE_LZ4 */
 
-    if (fd == -1)
-        return NULL;
-
     /* allocate FILE_T structure to return */
     state = (FILE_T)g_try_malloc0(sizeof *state);
     if (state == NULL)
@@ -1822,15 +1824,55 @@ err:
     return NULL;
 }
 
+FILE_T
+file_fdopen(int fd)
+{
+    if (fd == -1)
+        return NULL;
+
+    return file_reader_open(fd);
+}
+
+/*
+ * Open a shared memory ring dumpcap is writing to. There's no file
+ * descriptor; buf_read() reads from the ring instead, and, as with a
+ * pipe, we can't seek backwards beyond what's still in our buffer.
+ */
+static FILE_T
+file_open_shm_ring(const char *name)
+{
+    shm_ring_t *ring;
+    FILE_T ft;
+    int err;
+
+    ring = shm_ring_open(name, &err);
+    if (ring == NULL) {
+        errno = err;
+        return NULL;
+    }
+    ft = file_reader_open(-1);
+    if (ft == NULL) {
+        shm_ring_close(ring);
+        return NULL;
+    }
+    ft->shm = ring;
+    return ft;
+}
+
 FILE_T
 file_open(const char *path)
 {
     int fd;
     FILE_T ft;
+    const char *shm_name;
 #ifdef USE_ZLIB_OR_ZLIBNG
     const char *suffixp;
 #endif /* USE_ZLIB_OR_ZLIBNG */
 
+    shm_name = shm_ring_path_name(path);
+    if (shm_name != NULL)
+        return file_open_shm_ring(shm_name);
+
     /* open file and do correct filename conversions.
 
        XXX - do we need O_LARGEFILE?  On UN*X, if we need to do
@@ -2265,6 +2307,12 @@ file_tell_raw(FILE_T stream)
 int
 file_fstat(FILE_T stream, ws_statb64 *statb, int *err)
 {
+    if (stream->shm != NULL) {
+        /* It's not a file, and it has no size we could report. */
+        if (err != NULL)
+            *err = ESPIPE;
+        return -1;
+    }
     if (ws_fstat64(stream->fd, statb) == -1) {
         if (err != NULL)
             *err = errno;
@@ -2590,6 +2638,7 @@ file_close(FILE_T file)
         g_free(file->in.buf);
     }
     g_free(file->fast_seek_cur);
+    shm_ring_close(file->shm);
     file->err = 0;
     file->err_info = NULL;
     g_free(file);
@@ -258,6 +258,19 @@ typedef struct {
     GArray *sections;             /**< Sections found in the capture file. */
 } pcapng_t;
 
+/*
+ * Enhanced Packet Blocks up to this size, with no pseudo-header and no
+ * options other than fixed-size ones, are built in a buffer and handed
+ * to the output stream with a single write, rather than one write for
+ * each part of the block.
+ */
+#define PCAPNG_EPB_STAGING_SIZE 65536
+
+/* Private data for writing */
+typedef struct {
+    uint8_t epb_buf[PCAPNG_EPB_STAGING_SIZE]; /**< Staging buffer for Enhanced Packet Blocks */
+} pcapng_dump_t;
+
 /*
  * Table for plugins to handle particular block types.
  *
@@ -5361,6 +5374,86 @@ pcapng_write_simple_packet_block(wtap_dumper* wdh, const wtap_rec* rec,
     return true;
 }
 
+/*
+ * Append an EPB option to a staged block. Only the fixed-size options
+ * are handled; returning false for anything else makes the caller fall
+ * back to writing the block piece by piece.
+ */
+static bool
+stage_epb_option(wtap_block_t block _U_, unsigned option_id, wtap_opttype_e option_type _U_, wtap_optval_t *optval, void *user_data)
+{
+    uint8_t **p = (uint8_t **)user_data;
+    struct pcapng_option_header option_hdr;
+
+    switch(option_id)
+    {
+    case OPT_PKT_FLAGS:
+    case OPT_PKT_QUEUE:
+        option_hdr.type         = (uint16_t)(option_id == OPT_PKT_FLAGS ? OPT_EPB_FLAGS : OPT_EPB_QUEUE);
+        option_hdr.value_length = (uint16_t)4;
+        memcpy(*p, &option_hdr, 4);
+        memcpy(*p + 4, &optval->uint32val, 4);
+        *p += 8;
+        break;
+    case OPT_PKT_DROPCOUNT:
+    case OPT_PKT_PACKETID:
+        option_hdr.type         = (uint16_t)(option_id == OPT_PKT_DROPCOUNT ? OPT_EPB_DROPCOUNT : OPT_EPB_PACKETID);
+        option_hdr.value_length = (uint16_t)8;
+        memcpy(*p, &option_hdr, 4);
+        memcpy(*p + 4, &optval->uint64val, 8);
+        *p += 12;
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Build an EPB in the staging buffer and write it with one call.
+ * Returns false without writing anything if the block can't be staged.
+ */
+static bool
+pcapng_write_staged_epb(wtap_dumper *wdh, const wtap_rec *rec, const uint8_t *pd,
+                        const pcapng_block_header_t *bh,
+                        const pcapng_enhanced_packet_block_t *epb,
+                        uint32_t pad_len, uint32_t options_size,
+                        bool *written, int *err)
+{
+    pcapng_dump_t *pcapng_dump = (pcapng_dump_t *)wdh->priv;
+    uint8_t *p;
+
+    *written = false;
+    if (pcapng_dump == NULL || bh->block_total_length > PCAPNG_EPB_STAGING_SIZE)
+        return true;
+
+    p = pcapng_dump->epb_buf;
+    memcpy(p, bh, sizeof *bh);
+    p += sizeof *bh;
+    memcpy(p, epb, sizeof *epb);
+    p += sizeof *epb;
+    memcpy(p, pd, rec->rec_header.packet_header.caplen);
+    p += rec->rec_header.packet_header.caplen;
+    memset(p, 0, pad_len);
+    p += pad_len;
+    if (options_size != 0) {
+        if (!wtap_block_foreach_option(rec->block, stage_epb_option, &p))
+            return true;
+        /* End of options */
+        memset(p, 0, 4);
+        p += 4;
+    }
+    memcpy(p, &bh->block_total_length, sizeof bh->block_total_length);
+    p += sizeof bh->block_total_length;
+
+    /* Don't write a block whose length doesn't add up. */
+    if ((size_t)(p - pcapng_dump->epb_buf) != bh->block_total_length)
+        return true;
+
+    *written = true;
+    return wtap_dump_file_write(wdh, pcapng_dump->epb_buf, bh->block_total_length, err);
+}
+
 static bool
 pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
                                    const uint8_t *pd, int *err, char **err_info)
@@ -5459,14 +5552,11 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
         return false;
     }
 
-    /* write (enhanced) packet block header */
+    /* fill in (enhanced) packet block header */
     bh.block_type = BLOCK_TYPE_EPB;
     bh.block_total_length = (uint32_t)sizeof(bh) + (uint32_t)sizeof(epb) + phdr_len + rec->rec_header.packet_header.caplen + pad_len + options_total_length + options_size + 4;
 
-    if (!wtap_dump_file_write(wdh, &bh, sizeof bh, err))
-        return false;
-
-    /* write block fixed content */
+    /* fill in block fixed content */
     /* Calculate the time stamp as a 64-bit integer. */
     ts = ((uint64_t)rec->ts.secs) * int_data_mand->time_units_per_second +
         (((uint64_t)rec->ts.nsecs) * int_data_mand->time_units_per_second) / 1000000000;
@@ -5479,6 +5569,22 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
     epb.captured_len        = rec->rec_header.packet_header.caplen + phdr_len;
     epb.packet_len          = rec->rec_header.packet_header.len + phdr_len;
 
+    /* Most blocks can be written in one go. */
+    if (phdr_len == 0) {
+        bool written;
+
+        if (!pcapng_write_staged_epb(wdh, rec, pd, &bh, &epb, pad_len,
+                                     options_size, &written, err))
+            return false;
+        if (written)
+            return true;
+    }
+
+    /* write (enhanced) packet block header */
+    if (!wtap_dump_file_write(wdh, &bh, sizeof bh, err))
+        return false;
+
+    /* write block fixed content */
     if (!wtap_dump_file_write(wdh, &epb, sizeof epb, err))
         return false;
 
@@ -6737,6 +6843,7 @@ pcapng_dump_open(wtap_dumper *wdh, int *err, char **err_info _U_)
     wdh->subtype_add_idb = pcapng_add_idb;
     wdh->subtype_write = pcapng_dump;
     wdh->subtype_finish = pcapng_dump_finish;
+    wdh->priv = g_new(pcapng_dump_t, 1);
 
     /* write the section header block */
     if (!pcapng_write_section_header_block(wdh, err)) {
@@ -108,6 +108,7 @@ struct wtap_dumper {
     wtap_compression_type   compression_type;
     bool                    needs_reload;    /* true if the file requires re-loading after saving with wtap */
     int64_t                 bytes_dumped;
+    char                    *io_buffer;      /* standard I/O buffer for uncompressed output, if we supplied one */
 
     void                    *priv;           /* this one holds per-file state and is free'd automatically by wtap_dump_close() */
     void                    *wslua_data;     /* this one holds wslua state info and is not free'd */
@@ -17,6 +17,11 @@
 
 #include <wsutil/crc32.h>
 
+#include "crc32_int.h"
+#ifdef HAVE_SSE4_2
+#include "ws_cpuid.h"
+#endif
+
 #ifdef HAVE_ZLIBNG
 #include <zlib-ng.h>
 #else
@@ -373,21 +378,29 @@ crc32_ccitt_table_lookup (unsigned char pos)
 	return crc32_ccitt_table[pos];
 }
 
+#ifdef HAVE_SSE4_2
+/* -1 until the CPU has been checked, then whether it has SSE 4.2. */
+static int crc32c_use_sse42 = -1;
+#endif
+
 uint32_t
 crc32c_calculate(const void *buf, int len, uint32_t crc)
 {
-	const uint8_t *p = (const uint8_t *)buf;
-	crc = CRC32C_SWAP(crc);
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
-	}
-	return CRC32C_SWAP(crc);
+	return CRC32C_SWAP(crc32c_calculate_no_swap(buf, len, CRC32C_SWAP(crc)));
 }
 
 uint32_t
 crc32c_calculate_no_swap(const void *buf, int len, uint32_t crc)
 {
 	const uint8_t *p = (const uint8_t *)buf;
+
+#ifdef HAVE_SSE4_2
+	if (crc32c_use_sse42 == -1)
+		crc32c_use_sse42 = ws_cpuid_sse42() ? 1 : 0;
+	if (crc32c_use_sse42)
+		return crc32c_sse42_calculate_no_swap(buf, len, crc);
+#endif
+
 	while (len-- > 0) {
 		CRC32C(crc, *p++);
 	}
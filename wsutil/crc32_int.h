@@ -0,0 +1,22 @@
+/** @file
+ *
+ * Internal declarations for the CRC-32 routines
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __CRC32_INT_H__
+#define __CRC32_INT_H__
+
+#include <stdint.h>
+
+#ifdef HAVE_SSE4_2
+/* CRC32C using the SSE 4.2 crc32 instruction; check ws_cpuid_sse42() first. */
+uint32_t crc32c_sse42_calculate_no_swap(const void *buf, int len, uint32_t crc);
+#endif
+
+#endif /* __CRC32_INT_H__ */
@@ -0,0 +1,72 @@
+/* crc32c_sse42.c
+ * CRC32C routine using the SSE 4.2 crc32 instruction
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <string.h>
+
+#include <nmmintrin.h>
+
+#include "crc32_int.h"
+
+/*
+ * The crc32 instruction implements the same (reflected) CRC32C
+ * polynomial as crc32c_table, without any pre- or post-conditioning,
+ * so it's a drop-in replacement for the table lookup loop.
+ */
+uint32_t
+crc32c_sse42_calculate_no_swap(const void *buf, int len, uint32_t crc)
+{
+	const uint8_t *p = (const uint8_t *)buf;
+
+#if defined(__x86_64__) || defined(_M_X64)
+	uint64_t crc64 = crc;
+
+	while (len >= 8) {
+		uint64_t qw;
+
+		memcpy(&qw, p, sizeof(qw));
+		crc64 = _mm_crc32_u64(crc64, qw);
+		p += 8;
+		len -= 8;
+	}
+	crc = (uint32_t)crc64;
+#endif
+	while (len >= 4) {
+		uint32_t dw;
+
+		memcpy(&dw, p, sizeof(dw));
+		crc = _mm_crc32_u32(crc, dw);
+		p += 4;
+		len -= 4;
+	}
+	while (len-- > 0) {
+		crc = _mm_crc32_u8(crc, *p++);
+	}
+
+	return crc;
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,453 @@
+/* shm_ring.c
+ * Single-producer, single-consumer byte ring in POSIX shared memory
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#define _GNU_SOURCE
+#include "config.h"
+#include "shm_ring.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "ws_attributes.h"
+
+#if defined(HAVE_SHM_OPEN) && (defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN))
+#define SHM_RING_SUPPORTED
+#endif
+
+#ifdef SHM_RING_SUPPORTED
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHM_RING_MAGIC          0x57534852  /* "WSHR" */
+#define SHM_RING_VERSION        1
+#define SHM_RING_MIN_SIZE       (1024 * 1024)
+#define SHM_RING_POLL_USEC      200
+/* How many polls the reader waits between checks that the writer is alive */
+#define SHM_RING_LIVENESS_POLLS 500
+
+/*
+ * Keep the two counters on separate cache lines, so that the writer
+ * bumping head doesn't keep stealing the line the reader bumps tail on.
+ */
+typedef union {
+    atomic_size_t value;
+    char pad[64];
+} shm_ring_counter;
+
+/*
+ * Header at the start of the shared memory object; the data area follows
+ * it. head and tail count bytes written and read since the ring was
+ * created; the size is a power of 2, so they may wrap freely.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    int64_t writer_pid;
+    atomic_int writer_closed;
+    atomic_int reader_closed;
+    shm_ring_counter head;      /* advanced by the writer only */
+    shm_ring_counter tail;      /* advanced by the reader only */
+} shm_ring_header;
+
+struct shm_ring {
+    shm_ring_header *hdr;
+    uint8_t *data;
+    size_t size;
+    size_t map_size;
+    bool is_writer;
+    char *name;                 /* writer only, to unlink the object */
+    shm_ring_wait_cb wait_cb;
+    void *wait_cb_data;
+};
+
+static shm_ring_t *
+shm_ring_map(int fd, size_t map_size, bool is_writer, int *err)
+{
+    shm_ring_t *ring;
+    void *map;
+
+    map = mmap(NULL, map_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        *err = errno;
+        return NULL;
+    }
+
+    ring = g_new0(shm_ring_t, 1);
+    ring->hdr = (shm_ring_header *)map;
+    ring->data = (uint8_t *)map + sizeof(shm_ring_header);
+    ring->map_size = map_size;
+    ring->size = map_size - sizeof(shm_ring_header);
+    ring->is_writer = is_writer;
+    return ring;
+}
+
+bool
+shm_ring_is_supported(void)
+{
+    return true;
+}
+
+shm_ring_t *
+shm_ring_create(const char *name, size_t size, int *err)
+{
+    shm_ring_t *ring;
+    size_t data_size = SHM_RING_MIN_SIZE;
+    int fd;
+
+    if (name[0] != '/') {
+        *err = EINVAL;
+        return NULL;
+    }
+    while (data_size < size) {
+        data_size <<= 1;
+    }
+
+    /*
+     * Names are made unique by the caller (e.g. with its process ID), so
+     * an existing object was left behind by an earlier process that had
+     * the same name and whose reader never opened it.
+     */
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR|O_CREAT|O_EXCL, 0600);
+    if (fd == -1) {
+        *err = errno;
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)(sizeof(shm_ring_header) + data_size)) == -1) {
+        *err = errno;
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    ring = shm_ring_map(fd, sizeof(shm_ring_header) + data_size, true, err);
+    close(fd);
+    if (ring == NULL) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    ring->hdr->magic = SHM_RING_MAGIC;
+    ring->hdr->version = SHM_RING_VERSION;
+    ring->hdr->size = data_size;
+    ring->hdr->writer_pid = (int64_t)getpid();
+    atomic_init(&ring->hdr->writer_closed, 0);
+    atomic_init(&ring->hdr->reader_closed, 0);
+    atomic_init(&ring->hdr->head.value, 0);
+    atomic_init(&ring->hdr->tail.value, 0);
+    ring->name = g_strdup(name);
+    return ring;
+}
+
+shm_ring_t *
+shm_ring_open(const char *name, int *err)
+{
+    shm_ring_t *ring;
+    struct stat st;
+    int fd;
+
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1) {
+        *err = errno;
+        return NULL;
+    }
+    if (fstat(fd, &st) == -1) {
+        *err = errno;
+        close(fd);
+        return NULL;
+    }
+    if ((size_t)st.st_size <= sizeof(shm_ring_header)) {
+        *err = EINVAL;
+        close(fd);
+        return NULL;
+    }
+    ring = shm_ring_map(fd, (size_t)st.st_size, false, err);
+    close(fd);
+    if (ring == NULL) {
+        return NULL;
+    }
+    if (ring->hdr->magic != SHM_RING_MAGIC ||
+        ring->hdr->version != SHM_RING_VERSION ||
+        ring->hdr->size != ring->size ||
+        (ring->size & (ring->size - 1)) != 0) {
+        munmap(ring->hdr, ring->map_size);
+        g_free(ring);
+        *err = EINVAL;
+        return NULL;
+    }
+
+    /* We're the only reader; nobody else needs to find it by name. */
+    shm_unlink(name);
+    return ring;
+}
+
+void
+shm_ring_set_wait_cb(shm_ring_t *ring, shm_ring_wait_cb cb, void *user_data)
+{
+    ring->wait_cb = cb;
+    ring->wait_cb_data = user_data;
+}
+
+bool
+shm_ring_write(shm_ring_t *ring, const void *buf, size_t len, int *err)
+{
+    const uint8_t *src = (const uint8_t *)buf;
+    size_t head, tail, space, chunk, offset;
+    int64_t wait_start = 0;
+
+    head = atomic_load_explicit(&ring->hdr->head.value, memory_order_relaxed);
+    while (len > 0) {
+        tail = atomic_load_explicit(&ring->hdr->tail.value, memory_order_acquire);
+        space = ring->size - (head - tail);
+        if (space == 0) {
+            if (atomic_load_explicit(&ring->hdr->reader_closed, memory_order_acquire)) {
+                *err = EPIPE;
+                return false;
+            }
+            if (wait_start == 0) {
+                wait_start = g_get_monotonic_time();
+            }
+            if (ring->wait_cb != NULL &&
+                !ring->wait_cb(ring->wait_cb_data, (uint64_t)(g_get_monotonic_time() - wait_start))) {
+                *err = EINTR;
+                return false;
+            }
+            g_usleep(SHM_RING_POLL_USEC);
+            continue;
+        }
+        wait_start = 0;
+
+        /* Copy up to the end of the data area, then wrap. */
+        offset = head & (ring->size - 1);
+        chunk = MIN(MIN(len, space), ring->size - offset);
+        memcpy(ring->data + offset, src, chunk);
+        src += chunk;
+        len -= chunk;
+        head += chunk;
+        atomic_store_explicit(&ring->hdr->head.value, head, memory_order_release);
+    }
+    return true;
+}
+
+ssize_t
+shm_ring_read(shm_ring_t *ring, void *buf, size_t len)
+{
+    uint8_t *dst = (uint8_t *)buf;
+    size_t head, tail, avail, chunk, offset, copied = 0;
+    unsigned polls = 0;
+
+    tail = atomic_load_explicit(&ring->hdr->tail.value, memory_order_relaxed);
+    for (;;) {
+        head = atomic_load_explicit(&ring->hdr->head.value, memory_order_acquire);
+        avail = head - tail;
+        if (avail > 0) {
+            break;
+        }
+        if (atomic_load_explicit(&ring->hdr->writer_closed, memory_order_acquire)) {
+            /* Anything written before the close is visible by now. */
+            if (atomic_load_explicit(&ring->hdr->head.value, memory_order_acquire) == tail) {
+                return 0;
+            }
+            continue;
+        }
+        if (++polls % SHM_RING_LIVENESS_POLLS == 0 &&
+            kill((pid_t)ring->hdr->writer_pid, 0) == -1 && errno == ESRCH) {
+            /* The writer went away without closing; nothing more is coming. */
+            return 0;
+        }
+        g_usleep(SHM_RING_POLL_USEC);
+    }
+
+    len = MIN(len, avail);
+    while (copied < len) {
+        offset = (tail + copied) & (ring->size - 1);
+        chunk = MIN(len - copied, ring->size - offset);
+        memcpy(dst + copied, ring->data + offset, chunk);
+        copied += chunk;
+    }
+    atomic_store_explicit(&ring->hdr->tail.value, tail + copied, memory_order_release);
+    return (ssize_t)copied;
+}
+
+/* Standard I/O glue for the writer */
+#ifdef HAVE_FOPENCOOKIE
+static ssize_t
+shm_ring_cookie_write(void *cookie, const char *buf, size_t size)
+{
+    int err;
+
+    if (!shm_ring_write((shm_ring_t *)cookie, buf, size, &err)) {
+        errno = err;
+        return -1;
+    }
+    return (ssize_t)size;
+}
+#else
+static int
+shm_ring_cookie_write(void *cookie, const char *buf, int size)
+{
+    int err;
+
+    if (!shm_ring_write((shm_ring_t *)cookie, buf, (size_t)size, &err)) {
+        errno = err;
+        return -1;
+    }
+    return size;
+}
+#endif
+
+static int
+shm_ring_cookie_close(void *cookie)
+{
+    shm_ring_t *ring = (shm_ring_t *)cookie;
+
+    atomic_store_explicit(&ring->hdr->writer_closed, 1, memory_order_release);
+    return 0;
+}
+
+FILE *
+shm_ring_fdopen(shm_ring_t *ring)
+{
+    if (!ring->is_writer) {
+        errno = EBADF;
+        return NULL;
+    }
+#ifdef HAVE_FOPENCOOKIE
+    cookie_io_functions_t funcs = {
+        .read = NULL,
+        .write = shm_ring_cookie_write,
+        .seek = NULL,
+        .close = shm_ring_cookie_close,
+    };
+    return fopencookie(ring, "w", funcs);
+#else
+    return funopen(ring, NULL, shm_ring_cookie_write, NULL, shm_ring_cookie_close);
+#endif
+}
+
+void
+shm_ring_close(shm_ring_t *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+    if (ring->is_writer) {
+        /*
+         * Leave the object in place; the reader may not have opened it
+         * yet, and unlinks it once it has.
+         */
+        atomic_store_explicit(&ring->hdr->writer_closed, 1, memory_order_release);
+        g_free(ring->name);
+    } else {
+        atomic_store_explicit(&ring->hdr->reader_closed, 1, memory_order_release);
+    }
+    munmap(ring->hdr, ring->map_size);
+    g_free(ring);
+}
+
+void
+shm_ring_discard(shm_ring_t *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+    if (ring->is_writer) {
+        shm_unlink(ring->name);
+    }
+    shm_ring_close(ring);
+}
+
+#else /* SHM_RING_SUPPORTED */
+
+bool
+shm_ring_is_supported(void)
+{
+    return false;
+}
+
+shm_ring_t *
+shm_ring_create(const char *name _U_, size_t size _U_, int *err)
+{
+    *err = ENOTSUP;
+    return NULL;
+}
+
+shm_ring_t *
+shm_ring_open(const char *name _U_, int *err)
+{
+    *err = ENOTSUP;
+    return NULL;
+}
+
+void
+shm_ring_set_wait_cb(shm_ring_t *ring _U_, shm_ring_wait_cb cb _U_, void *user_data _U_)
+{
+}
+
+bool
+shm_ring_write(shm_ring_t *ring _U_, const void *buf _U_, size_t len _U_, int *err)
+{
+    *err = ENOTSUP;
+    return false;
+}
+
+ssize_t
+shm_ring_read(shm_ring_t *ring _U_, void *buf _U_, size_t len _U_)
+{
+    errno = ENOTSUP;
+    return -1;
+}
+
+FILE *
+shm_ring_fdopen(shm_ring_t *ring _U_)
+{
+    errno = ENOTSUP;
+    return NULL;
+}
+
+void
+shm_ring_close(shm_ring_t *ring _U_)
+{
+}
+
+void
+shm_ring_discard(shm_ring_t *ring _U_)
+{
+}
+
+#endif /* SHM_RING_SUPPORTED */
+
+const char *
+shm_ring_path_name(const char *path)
+{
+    if (path == NULL || strncmp(path, SHM_RING_PATH_PREFIX, strlen(SHM_RING_PATH_PREFIX)) != 0) {
+        return NULL;
+    }
+    return path + strlen(SHM_RING_PATH_PREFIX);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,128 @@
+/** @file
+ *
+ * Single-producer, single-consumer byte ring in POSIX shared memory,
+ * used to hand capture data from dumpcap to its parent without going
+ * through a temporary file.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_SHM_RING_H__
+#define __WS_SHM_RING_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Prefix of the "file name" reported by dumpcap when it writes into a
+ * shared memory ring. The rest of the name is the shared memory object
+ * name, as given to shm_open().
+ */
+#define SHM_RING_PATH_PREFIX    "shm:"
+
+/**
+ * Default size of the data area. It must be comfortably larger than the
+ * largest block dumpcap can write.
+ */
+#define SHM_RING_DEFAULT_SIZE   (64 * 1024 * 1024)
+
+typedef struct shm_ring shm_ring_t;
+
+/**
+ * Called by the writer while the ring is full, with the number of
+ * microseconds it has been waiting for the reader so far. Return false
+ * to give up the write.
+ */
+typedef bool (*shm_ring_wait_cb)(void *user_data, uint64_t waited_usec);
+
+/**
+ * @brief Check whether shared memory rings can be used on this platform.
+ * @return true if shm_ring_create() and shm_ring_fdopen() are available.
+ */
+WS_DLL_PUBLIC bool shm_ring_is_supported(void);
+
+/**
+ * @brief Get the shared memory object name from a path.
+ * @param path A path that may start with SHM_RING_PATH_PREFIX.
+ * @return The object name, or NULL if path doesn't refer to a ring.
+ */
+WS_DLL_PUBLIC const char *shm_ring_path_name(const char *path);
+
+/**
+ * @brief Create a new ring for writing. Any existing object with the
+ * same name is removed first.
+ * @param name The shared memory object name; must start with '/'.
+ * @param size Size of the data area; rounded up to a power of 2.
+ * @param err Set to an errno value on failure.
+ * @return The ring, or NULL on failure.
+ */
+WS_DLL_PUBLIC shm_ring_t *shm_ring_create(const char *name, size_t size, int *err);
+
+/**
+ * @brief Open an existing ring for reading. The shared memory object is
+ * unlinked once it's mapped, so it goes away with the last process using it.
+ * @param name The shared memory object name.
+ * @param err Set to an errno value on failure.
+ * @return The ring, or NULL on failure.
+ */
+WS_DLL_PUBLIC shm_ring_t *shm_ring_open(const char *name, int *err);
+
+/**
+ * @brief Set the callback the writer calls while waiting for free space.
+ */
+WS_DLL_PUBLIC void shm_ring_set_wait_cb(shm_ring_t *ring, shm_ring_wait_cb cb, void *user_data);
+
+/**
+ * @brief Copy data into the ring, waiting for the reader to make room
+ * if necessary.
+ * @return true on success, false with *err set on failure.
+ */
+WS_DLL_PUBLIC bool shm_ring_write(shm_ring_t *ring, const void *buf, size_t len, int *err);
+
+/**
+ * @brief Read up to len bytes from the ring, waiting until at least one
+ * byte is available or the writer has finished.
+ * @return The number of bytes read, 0 at the end of the data, or -1 with
+ * errno set on error.
+ */
+WS_DLL_PUBLIC ssize_t shm_ring_read(shm_ring_t *ring, void *buf, size_t len);
+
+/**
+ * @brief Get a standard I/O stream that writes into the ring. Closing
+ * the stream marks the end of the data but doesn't free the ring.
+ * @return The stream, or NULL with errno set on failure.
+ */
+WS_DLL_PUBLIC FILE *shm_ring_fdopen(shm_ring_t *ring);
+
+/**
+ * @brief Mark this end of the ring closed, unmap it and free it. The
+ * writer leaves the shared memory object for the reader to open.
+ */
+WS_DLL_PUBLIC void shm_ring_close(shm_ring_t *ring);
+
+/**
+ * @brief Like shm_ring_close(), but also remove the shared memory object,
+ * for a writer whose reader will never open it.
+ */
+WS_DLL_PUBLIC void shm_ring_discard(shm_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WS_SHM_RING_H__ */
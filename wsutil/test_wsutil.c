@@ -663,6 +663,52 @@ void test_nstime_from_iso8601(void)
     g_assert_cmpint(result.nsecs, ==, expect.nsecs);
 }
 
+#include "crc32.h"
+
+/* Byte at a time with the table, which is what crc32c_calculate_no_swap()
+ * does without SSE 4.2. */
+static uint32_t crc32c_reference(const uint8_t *buf, int len, uint32_t crc)
+{
+    while (len-- > 0) {
+        crc = (crc >> 8) ^ crc32c_table_lookup((uint8_t)(crc ^ *buf++));
+    }
+    return crc;
+}
+
+static void test_crc32c(void)
+{
+    uint8_t buf[4096 + 16];
+    uint8_t iscsi[32];
+    GRand *rand;
+    unsigned i;
+    int offset, len;
+    uint32_t seed;
+
+    /* RFC 3720, B.4: 32 bytes of zeroes. */
+    memset(iscsi, 0, sizeof(iscsi));
+    g_assert_cmphex(~crc32c_calculate_no_swap(iscsi, (int)sizeof(iscsi), CRC32C_PRELOAD), ==, 0x8a9136aa);
+    g_assert_cmphex(crc32c_calculate(iscsi, (int)sizeof(iscsi), CRC32C_PRELOAD), ==, CRC32C_SWAP(~0x8a9136aaU));
+
+    /* Where the CPU has SSE 4.2, this compares the crc32 instruction with
+     * the table: odd lengths, unaligned starts, and long inputs that go
+     * through the 8-byte loop many times. */
+    rand = g_rand_new_with_seed(0x1edc6f41);
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)g_rand_int(rand);
+    }
+    for (offset = 0; offset < 16; offset++) {
+        for (len = 0; len <= 67; len++) {
+            seed = g_rand_int(rand);
+            g_assert_cmphex(crc32c_calculate_no_swap(buf + offset, len, seed), ==,
+                            crc32c_reference(buf + offset, len, seed));
+        }
+        len = (int)sizeof(buf) - 16 - offset;
+        g_assert_cmphex(crc32c_calculate_no_swap(buf + offset, len, CRC32C_PRELOAD), ==,
+                        crc32c_reference(buf + offset, len, CRC32C_PRELOAD));
+    }
+    g_rand_free(rand);
+}
+
 #include "ws_getopt.h"
 
 #define ARGV_MAX 31
@@ -881,6 +927,8 @@ int main(int argc, char **argv)
 
     g_test_add_func("/nstime/from_iso8601", test_nstime_from_iso8601);
 
+    g_test_add_func("/crc32/crc32c", test_crc32c);
+
     g_test_add_func("/ws_getopt/basic1", test_getopt_long_basic1);
     g_test_add_func("/ws_getopt/basic2", test_getopt_long_basic2);
     g_test_add_func("/ws_getopt/optional1", test_getopt_optional_argument1);